@@ -17,6 +17,12 @@ extern pcb_PTR outBlocked (pcb_PTR p);
 extern pcb_PTR headBlocked (int *semAdd);
 extern void initASL ();
 
+#ifdef SEMSTATS
+extern void semStatP (int *semAdd, pcb_PTR p, BOOL contended, int now);
+extern void semStatV (int *semAdd, pcb_PTR p, pcb_PTR woken, int blockedAt, int now);
+extern int semStatTop (semstat_t *buffer, int n);
+#endif
+
 /***************************************************************/
 
 #endif
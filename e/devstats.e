@@ -0,0 +1,20 @@
+#ifndef DEVICESTATS
+#define DEVICESTATS
+
+/************************* DEVSTATS.E *****************************
+*
+*  The externals declaration file for the Device Statistics
+*    Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void devStatIssue (int semaphoreIndex, int now);
+extern void devStatComplete (int semaphoreIndex, BOOL error, int now);
+extern void devStatRead (devstat_t *report, BOOL reset, int now);
+
+/***************************************************************/
+
+#endif
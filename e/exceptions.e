@@ -16,6 +16,8 @@ extern void updateTime();
 extern void PGMTrapHandler();
 extern void TLBTrapHandler();
 extern void SYSCallHandler();
+extern int depthFirstMurder(pcb_PTR observedProcess);
+extern void admitCreators();
 
 /***************************************************************/
 
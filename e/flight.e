@@ -0,0 +1,24 @@
+#ifndef FLIGHT
+#define FLIGHT
+
+/************************* FLIGHT.E *****************************
+*
+*  The externals declaration file for the Flight Recorder
+*    Module.
+*
+*  flightEvent() is called by every TRACE() tracepoint when the
+*  nucleus is built with -DKFLIGHT (see trace.e). flightTick() and
+*  flightDump() are always there.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void flightEvent (int type, pcb_PTR proc, unsigned int arg);
+extern void flightTick ();
+extern void flightDump (int reason);
+
+/***************************************************************/
+
+#endif
@@ -23,12 +23,26 @@ extern int 			g_endOfInterval;		// When the interval timer will run dry (calcula
 
 extern pcb_PTR 		g_currentProc;			// holds the current state that is actually running
 extern pcb_PTR 		g_readyQueue;			// tp->ProcBlk of processes: ready AND waiting for turn of execution
+extern pcb_PTR 		g_suspendedQueue;		// tp->ProcBlk of processes: ready BUT parked by SUSPENDGROUP
+extern pcb_PTR 		g_throttledQueue;		// tp->ProcBlk of processes: ready BUT out of CPU budget
+
+extern BOOL 		g_budgetsInUse;			// has anyone ever set a CPU budget?
+extern int 			g_budgetEpoch;			// bumped every replenishment, stale p_budgetUsed is 0
+extern int 			g_budgetTicks;			// intervals since the last replenishment
+
+extern pcb_PTR 		g_groupTable[MAXGROUPS];	// tp->ProcBlk of each process group's members
 
 extern int g_lotOfSemaphores[MAXSEMA4]; 	// initialize all semaphores:
 								// 8 * (Disks, Tapes, Printers, Networking Devices), 16 Terminals, 1 Clock
 
 extern int g_deviceStatus[MAXSEMA4]; 		// status held for each device's semaphore
 
+extern int g_pcbSemaphore; 					// creators blocked in SYS 1 waiting for a free ProcBlk
+
+extern BOOL 		g_profiling;			// is PROFSTART sampling PCs?
+extern int 			g_profPeriod;			// sample this often inside a quantum, 0 = only at line 2 interrupts
+extern int 			g_endOfQuantum;			// when the current process' time slice ends (calculated "date")
+
 extern void main ();
 
 /***************************************************************/
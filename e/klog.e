@@ -0,0 +1,22 @@
+#ifndef KLOG
+#define KLOG
+
+/************************* KLOG.E *****************************
+*
+*  The externals declaration file for the Kernel Log
+*    Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void klog (int level, char *msg);
+extern void klogHex (int level, char *msg, unsigned int value);
+extern int klogRead (char *buffer, int maxBytes, int *dropped);
+extern BOOL klogInterrupt (int semaphoreIndex);
+extern void klogFlush ();
+
+/***************************************************************/
+
+#endif
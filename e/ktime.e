@@ -0,0 +1,25 @@
+#ifndef KTIME
+#define KTIME
+
+/************************* KTIME.E *****************************
+*
+*  The externals declaration file for the Kernel Time
+*    Accounting Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern int kernelEnter (int path);
+extern void kernelEnterAt (int path, int now);
+extern void kernelSwitch (int path);
+extern void kernelIdle (int now);
+extern void kernelLeaveAt (int now);
+extern void kernelLeave ();
+extern void kernelTimeRead (ktime_t *report, BOOL reset);
+extern unsigned int kernelIdleTotal ();
+
+/***************************************************************/
+
+#endif
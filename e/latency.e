@@ -0,0 +1,20 @@
+#ifndef LATENCY
+#define LATENCY
+
+/************************* LATENCY.E *****************************
+*
+*  The externals declaration file for the Wake Up Latency
+*    Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void latencyWoken (pcb_PTR p, int latClass, int interruptTOD);
+extern void latencyDispatched (pcb_PTR p, int dispatchTOD);
+extern void latencyRead (lathist_t *report, BOOL reset);
+
+/***************************************************************/
+
+#endif
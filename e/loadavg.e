@@ -0,0 +1,19 @@
+#ifndef LOADAVERAGE
+#define LOADAVERAGE
+
+/************************* LOADAVG.E *****************************
+*
+*  The externals declaration file for the Load Average
+*    Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void loadSample (int now);
+extern void loadRead (loadavg_t *report);
+
+/***************************************************************/
+
+#endif
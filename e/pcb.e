@@ -14,6 +14,8 @@
 extern void freePcb (pcb_PTR p);
 extern pcb_PTR allocPcb ();
 extern void initPcbs ();
+extern pcb_PTR findPcb (int pid);
+extern pcb_PTR pcbSlot (int slot);
 
 extern pcb_PTR mkEmptyProcQ ();
 extern int emptyProcQ (pcb_PTR tp);
@@ -21,12 +23,18 @@ extern void insertProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR removeProcQ (pcb_PTR *tp);
 extern pcb_PTR outProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR headProcQ (pcb_PTR tp);
+extern int procQLength (pcb_PTR tp);
 
 extern int emptyChild (pcb_PTR p);
 extern void insertChild (pcb_PTR prnt, pcb_PTR p);
 extern pcb_PTR removeChild (pcb_PTR p);
 extern pcb_PTR outChild (pcb_PTR p);
 
+extern void insertGroup (pcb_PTR *tp, pcb_PTR p);
+extern pcb_PTR outGroup (pcb_PTR *tp, pcb_PTR p);
+extern pcb_PTR headGroup (pcb_PTR tp);
+extern pcb_PTR nextGroup (pcb_PTR tp, pcb_PTR p);
+
 /***************************************************************/
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef PROFILE
+#define PROFILE
+
+/************************* PROFILE.E *****************************
+*
+*  The externals declaration file for the PC-Sampling Profiler
+*    Module.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void profStart (int pid, int period);
+extern int profStop ();
+extern int profRead (profent_t *buffer, int maxEntries);
+extern void profSample (pcb_PTR p);
+
+/***************************************************************/
+
+#endif
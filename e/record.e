@@ -0,0 +1,58 @@
+#ifndef RECORD
+#define RECORD
+
+/************************* RECORD.E ****************************
+*
+*  The externals declaration file for the Phase 1 Call Recorder
+*    Module.
+*
+*  Built with -DKRECORD, every phase 2 file that includes this
+*  after pcb.e and asl.e has its calls to the ProcBlk and ASL
+*  modules go through the recording wrappers instead. Without
+*  it the names are left alone and RECORDDUMP() is nothing.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+#ifdef KRECORD
+extern pcb_PTR recAllocPcb ();
+extern void recFreePcb (pcb_PTR p);
+extern void recInsertProcQ (pcb_PTR *tp, pcb_PTR p);
+extern pcb_PTR recRemoveProcQ (pcb_PTR *tp);
+extern pcb_PTR recOutProcQ (pcb_PTR *tp, pcb_PTR p);
+extern pcb_PTR recHeadProcQ (pcb_PTR tp);
+extern void recInsertChild (pcb_PTR prnt, pcb_PTR p);
+extern pcb_PTR recRemoveChild (pcb_PTR prnt);
+extern pcb_PTR recOutChild (pcb_PTR p);
+extern int recInsertBlocked (int *semAdd, pcb_PTR p);
+extern pcb_PTR recRemoveBlocked (int *semAdd);
+extern pcb_PTR recOutBlocked (pcb_PTR p);
+extern pcb_PTR recHeadBlocked (int *semAdd);
+extern void recordDump ();
+
+#ifndef RECORDER
+#define allocPcb()				recAllocPcb()
+#define freePcb(p)				recFreePcb(p)
+#define insertProcQ(tp, p)		recInsertProcQ((tp), (p))
+#define removeProcQ(tp)			recRemoveProcQ(tp)
+#define outProcQ(tp, p)			recOutProcQ((tp), (p))
+#define headProcQ(tp)			recHeadProcQ(tp)
+#define insertChild(prnt, p)	recInsertChild((prnt), (p))
+#define removeChild(prnt)		recRemoveChild(prnt)
+#define outChild(p)				recOutChild(p)
+#define insertBlocked(sem, p)	recInsertBlocked((sem), (p))
+#define removeBlocked(sem)		recRemoveBlocked(sem)
+#define outBlocked(p)			recOutBlocked(p)
+#define headBlocked(sem)		recHeadBlocked(sem)
+#endif
+
+#define RECORDDUMP()			recordDump()
+#else
+#define RECORDDUMP()
+#endif
+
+/***************************************************************/
+
+#endif
@@ -11,6 +11,12 @@
 #include "../h/types.h"
 
 extern void scheduler ();
+extern void armQuantum (int timeSlice);
+extern void makeReady (pcb_PTR p);
+extern void markBlocked (pcb_PTR p, int category);
+extern void chargeBudgets (pcb_PTR p, int time);
+extern pcb_PTR overBudget (pcb_PTR p);
+extern void replenishBudgets ();
 
 /***************************************************************/
 
@@ -0,0 +1,51 @@
+#ifndef TRACING
+#define TRACING
+
+/************************* TRACE.E *****************************
+*
+*  The externals declaration file for the Kernel Trace
+*    Module.
+*
+*  Tracepoints are written as TRACE(type, proc, arg). They feed the
+*  trace ring with -DKTRACE and the flight recorder (flight.e) with
+*  -DKFLIGHT; built with neither they compile to nothing, so the
+*  default nucleus pays no call and no TOD read for them. The
+*  exporter hooks in the scheduler and interrupt handler compile to
+*  nothing without -DKTRACE.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+#include "../e/flight.e"
+
+extern void traceEvent (int type, pcb_PTR proc, unsigned int arg);
+extern void traceSysExit ();
+extern int traceRead (traceev_t *buffer, int maxEvents);
+extern void traceExportIdle ();
+extern void traceExportFlush ();
+extern BOOL traceExportInterrupt (int semaphoreIndex);
+
+#ifdef KFLIGHT
+#define FLIGHTEVENT(type, proc, arg)	flightEvent((type), (proc), (arg))
+#else
+#define FLIGHTEVENT(type, proc, arg)
+#endif
+
+#ifdef KTRACE
+#define TRACE(type, proc, arg)	do { FLIGHTEVENT((type), (proc), (arg)); traceEvent((type), (proc), (arg)); } while(0)
+#define TRACESYSEXIT()			traceSysExit()
+#define TRACEIDLE()				traceExportIdle()
+#define TRACEFLUSH()			traceExportFlush()
+#define TRACEEXPORTED(index)	traceExportInterrupt(index)
+#else
+#define TRACE(type, proc, arg)	FLIGHTEVENT((type), (proc), (arg))
+#define TRACESYSEXIT()
+#define TRACEIDLE()
+#define TRACEFLUSH()
+#define TRACEEXPORTED(index)	FALSE
+#endif
+
+/***************************************************************/
+
+#endif
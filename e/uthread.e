@@ -0,0 +1,22 @@
+#ifndef UTHREAD
+#define UTHREAD
+
+/************************* UTHREAD.E *****************************
+*
+*  The externals declaration file for the User-Level Threads
+*    Library.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#include "../h/types.h"
+
+extern void uthreadInit (unsigned int stackTop);
+extern int uthreadCreate (void (*body)(), unsigned int stackTop);
+extern void uthreadYield ();
+extern void uthreadExit ();
+extern void uthreadRun ();
+
+/***************************************************************/
+
+#endif
@@ -6,8 +6,14 @@
  * All constants are defined here
  * 
  ****************************************************************************/
-#include "/usr/include/uarm/arch.h"
-#include "/usr/include/uarm/uARMconst.h"
+#include "uarm/arch.h"
+#include "uarm/uARMconst.h"
+
+// Physical addresses are used as they are, except in the host build whose
+//	mock arch.h maps them into its simulated bus
+#ifndef PHYSADDR
+#define PHYSADDR(address)	(address)
+#endif
 
 // Boolean Aliases
 #define BOOL				int
@@ -19,6 +25,9 @@
 
 // Hardcoded max number of processes
 #define MAXPROC  			20
+#define MAXGROUPS			MAXPROC 	// at most one group per process
+#define MAXCREATEWAIT		(MAXPROC / 2)	// creators allowed to block in SYS 1 at once
+#define MAXACTIVATIONS		(MAXPROC / 4)	// processes in a group sharing one SPECUPCALL state
 
 // Cause Register Aliases
 // REMEMBER, 0 IS ENABLED, 1 IS DISABLED!!!
@@ -38,14 +47,14 @@
 #define SYSMODE 			0x0000001F 		// last 5 bits
 
 // Stored Processor States (page 24 PrinciplesOfOperation)
-#define INTOLDADD			0x00007000
-#define INTNEWADD	 		0x00007058
-#define TLBOLDADD			0x000070B0
-#define TLBNEWADD			0x00007108
-#define PGMTOLDADD			0x00007160
-#define PGMTNEWADD			0x000071B8
-#define SYSOLDADD			0x00007210
-#define SYSNEWADD			0x00007268
+#define INTOLDADD			PHYSADDR(0x00007000)
+#define INTNEWADD	 		PHYSADDR(0x00007058)
+#define TLBOLDADD			PHYSADDR(0x000070B0)
+#define TLBNEWADD			PHYSADDR(0x00007108)
+#define PGMTOLDADD			PHYSADDR(0x00007160)
+#define PGMTNEWADD			PHYSADDR(0x000071B8)
+#define SYSOLDADD			PHYSADDR(0x00007210)
+#define SYSNEWADD			PHYSADDR(0x00007268)
 
 // Miscellaneous
 #define MAXSEMA4			49
@@ -53,11 +62,118 @@
 #define PCPREFETCH			4
 #define RI					20 			// Reserved Instruction - page 9
 
+// User-level threads (uthread.c)
+#define MAXUTHREADS			16
+#define MAXHOSTS			4 			// kernel processes running threads at once
+#define UTSTACKSIZE			1024 		// bytes of stack per thread and per host
+#define ORIGINALHOST		0 			// host slot of the process that called uthreadRun()
+
 // Time Related
+#ifndef QUANTUM 						// the host simulator builds other policies
 #define QUANTUM				5000 		// full CPU burst in microseconds
+#endif
 #define INTERVAL			100000		// full interval timer in microseconds
 #define CLOCKINDEX			48 			// the last device
 
+// CPU budgets
+#define BUDGETPERIOD		10 			// intervals between replenishments (1 second)
+#define BUDGETSUBTREE		0x00000001 	// descendants are charged to the budget too
+#define BUDGETKILL			0x00000002 	// terminate instead of throttling
+
+// Process states reported by SNAPSHOT
+#define PSRUNNING			0 			// g_currentProc (the caller)
+#define PSREADY				1
+#define PSBLOCKED			2 			// on a semaphore, see ps_semAdd/ps_device
+#define PSSUSPENDED			3 			// parked by SUSPENDGROUP
+#define PSTHROTTLED			4 			// parked until its budget is replenished
+#define NODEVICE			-1 			// ps_device when not waiting on a device
+
+// Why a process is blocked, for per-category blocked time
+#define NOTBLOCKED			-1
+#define BLOCKSEM			0 			// P on an ordinary semaphore (or waiting for a ProcBlk)
+#define BLOCKIO				1 			// SYS 8
+#define BLOCKCLOCK			2 			// SYS 7
+#define BLOCKCATS			3
+
+// Kernel tracepoints (trace.c, only recorded when built with -DKTRACE)
+#define TRACESIZE			256 		// events kept in the ring, a power of 2
+#define TR_DISPATCH			1 			// arg: 0
+#define TR_QUANTUM			2 			// arg: 0
+#define TR_SYSENTER			3 			// arg: SYS number
+#define TR_SYSEXIT			4 			// arg: SYS number
+#define TR_INTERRUPT		5 			// arg: (line << 8) | device
+#define TR_BLOCK			6 			// arg: BLOCKSEM, BLOCKIO or BLOCKCLOCK
+#define TR_WAKE				7 			// arg: same as the TR_BLOCK it ends
+#define TR_CREATE			8 			// arg: parent's PID
+#define TR_TERMINATE		9 			// arg: 0
+#define TR_LOST				10 			// arg: events overwritten before being read
+
+// Trace export (trace.c): the exporter owns disk TRACEDISK outright
+#define TRACEDISK			1 			// disk 1 (line 3), never handed to SYS 8
+#define TRACEDISKINDEX		TRACEDISK 	// its semaphore index, disks are line 3
+#define TRACEMAGIC			0x4352544B 	// "KTRC" in memory, starts every exported block
+#define DISKBLOCKSIZE		4096 		// one disk sector
+#define TRACEBLKEVENTS		((DISKBLOCKSIZE / 16) - 1) // traceev_t per block after the header
+#define DISKSEEKCYL			2 			// disk commands, (cyl << 8) | DISKSEEKCYL
+#define DISKWRITEBLK		4 			// (head << 16) | (sect << 8) | DISKWRITEBLK
+#define DEVICEBUSY			3 			// dtp status while an operation is running
+#define DEVSTATUSMASK		0xFF 		// status code part of a dtp status
+#define DEVNOTINSTALLED		0 			// status of a device uARM was not given
+
+// Flight recorder (flight.c): dumped to terminal FLIGHTTERM before the nucleus PANICs
+#define FLIGHTSIZE			64 			// last events kept, a power of 2
+#define FLIGHTTICKS			16 			// softBlockCount samples kept, one per interval
+#define FLIGHTTERM			1 			// terminal 1, polled
+#define FR_DEADLOCK			1 			// PANIC reasons: nothing ready, nothing soft blocked
+#define FR_NOLINE			2 			// interrupt with no line pending
+#define FR_NODEVICE			3 			// line pending but no device on it
+#define FR_BADLINE			4 			// line 0 or 1 reached the device handler
+#define FR_NOWAITER			5 			// semaphore said someone was blocked, ASL disagreed
+#define FR_CLOCKWAIT		6 			// SYS 7 fell through
+
+// Kernel log (klog.c): drained to terminal KLOGTERM, which the nucleus owns outright
+#define KLOGSIZE			2048 		// bytes of log text kept, a power of 2
+#define KLOGTERM			2 			// terminal 2, never handed to SYS 8
+#define KLOGTERMINDEX		(((LINENUMSEVEN - DEVICEOFFSET) * TOTALDEVICES) + KLOGTERM)
+#define KL_ERR				0 			// log levels, most severe first
+#define KL_WARN				1
+#define KL_INFO				2
+#define KL_DEBUG			3
+#define KLOGLEVEL			KL_INFO 	// messages less severe than this are not kept
+
+// PC-sampling profiler (profile.c)
+#define PROFBUCKETS			512 		// distinct (PID, PC) pairs kept, a power of 2
+#define PROFALLPROCS		0 			// PROFSTART pid that samples everyone
+
+// Wake up latency histograms (latency.c)
+#define LATBUCKETS			20 			// bucket i counts [2^i, 2^(i+1)) ticks, the last one everything longer
+#define LATCLOCK			5 			// classes 0-4 are lines 3-7, this is the pseudo-clock
+#define LATCLASSES			6
+#define NOWAKE				-1 			// p_wakeClass of a process not woken by an interrupt
+
+// Semaphore statistics (asl.c, only kept when built with -DSEMSTATS)
+#define SEMSTATSIZE			128 		// distinct semaphores tracked, a power of 2
+
+// Phase 1 call recorder (record.c, only built in with -DKRECORD)
+#define RECORDSIZE			16384 		// calls kept, recording stops when full
+#define RECSEMS				128 		// distinct semaphore addresses named
+#define RECQUEUES			32 			// distinct queue (tail pointer) addresses named
+#define RC_NONE				0xFF 		// a NULL ProcBlk, or a name the tables ran out of
+#define RC_ALLOCPCB			1 			// r: pcb
+#define RC_FREEPCB			2 			// a: pcb
+#define RC_INSERTPROCQ		3 			// a: queue, b: pcb
+#define RC_REMOVEPROCQ		4 			// a: queue, r: pcb
+#define RC_OUTPROCQ			5 			// a: queue, b: pcb, r: pcb
+#define RC_HEADPROCQ		6 			// a: tail pcb, r: pcb
+#define RC_INSERTCHILD		7 			// a: parent, b: pcb
+#define RC_REMOVECHILD		8 			// a: parent, r: pcb
+#define RC_OUTCHILD			9 			// a: pcb, r: pcb
+#define RC_INSERTBLOCKED	10 			// a: sem, b: pcb, r: result
+#define RC_REMOVEBLOCKED	11 			// a: sem, r: pcb
+#define RC_OUTBLOCKED		12 			// a: pcb, r: pcb
+#define RC_HEADBLOCKED		13 			// a: sem, r: pcb
+#define RC_OPS				14
+
 // SYS call numbers
 #define CREATEPROCESS		1
 #define TERMINATEPROCESS	2
@@ -68,6 +184,84 @@
 #define WAITCLOCK			7
 #define	WAITIO				8
 
+// SYS 9 is never handled by the nucleus so it is always passed up
+// (p2test relies on this), the extended services start after it
+#define RESERVEDSYS			9
+
+// Process group SYS calls
+#define SETGROUP			10
+#define SUSPENDGROUP		11
+#define RESUMEGROUP			12
+#define SIGNALGROUP			13
+#define TERMINATEGROUP		14
+#define GETSIGNALS			15
+
+// Cooperative switching SYS calls
+#define YIELD				16
+#define YIELDTO				17
+#define GETPID				18
+
+// User-level threading SYS call
+#define SPECUPCALL			19
+
+// CPU budget SYS calls
+#define SETBUDGET			20
+#define GETBUDGET			21
+
+// CPU time rollup SYS call
+#define GETTIMES			22
+
+// Process table snapshot SYS call
+#define SNAPSHOT			23
+
+// Scheduling counters SYS call
+#define GETSCHEDSTATS		24
+
+// Kernel trace SYS call
+#define READTRACE			25
+
+// PC-sampling profiler SYS calls
+#define PROFSTART			26
+#define PROFSTOP			27
+#define PROFREAD			28
+
+// Latency histogram SYS call
+#define READLATENCY			29
+
+// Semaphore statistics SYS call
+#define SEMTOP				30
+
+// Device statistics SYS call
+#define DEVSTATS			31
+
+// Kernel time breakdown SYS call
+#define KERNELTIME			32
+
+// Load average SYS call
+#define LOADAVG				33
+
+// Kernel log SYS call
+#define KLOGREAD			34
+
+#define LASTSYSCALL			KLOGREAD 	// anything above this is passed up
+
+// Kernel paths timed by ktime.c: SYS 0..LASTSYSCALL use their own number
+#define KPPASSUP			(LASTSYSCALL + 1) 	// SYS calls passed up (or killed)
+#define KPPGM				(LASTSYSCALL + 2)
+#define KPTLB				(LASTSYSCALL + 3)
+#define KPINTBASE			(LASTSYSCALL + 4) 	// + line number, 8 of them
+#define KPSCHED				(LASTSYSCALL + 12) 	// scheduler() picking the next process
+#define KPATHS				(LASTSYSCALL + 13)
+#define NOPATH				-1 					// not in the nucleus (or idle in WAIT)
+
+// Load averages: fixed point with LOADSHIFT fraction bits, decayed every INTERVAL
+#define LOADSHIFT			11
+#define LOADONE				(1 << LOADSHIFT)
+#define LOADEXP1			753 	// LOADONE / e^(1/1), a 1 interval time constant
+#define LOADEXP5			1677 	// LOADONE / e^(1/5)
+#define LOADEXP15			1916 	// LOADONE / e^(1/15)
+#define LOADAVGS			3
+
 // Trap Types
 #define TLBTRAP				0
 #define PGMTRAP				1
@@ -121,22 +315,23 @@
 #define RECEIVING			TRUE
 #define TRANSMITTING		FALSE
 #define ISOLATEREADY		0x0000000F	// 11111111 in binary
+#define CHARDONE			5 			// terminal status: character received/transmitted
 
 // Device Related
 #define DEVICEOFFSET		3
 #define TOTALDEVICES		8
 #define TOTALLINENUMS		8
-#define DEVBASEADDRESS		0x00000040
+#define DEVBASEADDRESS		PHYSADDR(0x00000040)
 #define DEVWORDLENGTH		0x00000010
 #define LASTSEMINDEX		48
 
 
 // Pending Iterrupt Bitmap (p. 21 Principles)
-#define TERMINALINTMAP		0x00006FF0
-#define PRINTERINTMAP		0x00006FEC
-#define NETWORKINTMAP		0x00006FE8
-#define TAPEINTMAP			0x00006FE4
-#define DISKINTMAP			0x00006FE0
+#define TERMINALINTMAP		PHYSADDR(0x00006FF0)
+#define PRINTERINTMAP		PHYSADDR(0x00006FEC)
+#define NETWORKINTMAP		PHYSADDR(0x00006FE8)
+#define TAPEINTMAP			PHYSADDR(0x00006FE4)
+#define DISKINTMAP			PHYSADDR(0x00006FE0)
 
 #define LINENUMOFFSET		24
 
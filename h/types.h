@@ -9,7 +9,7 @@
 #include "./const.h"
 
 
-//  #include "/usr/include/uarm/uARMtypes.h"
+//  #include "uarm/uARMtypes.h"
 //  ^ copy whats needed - commented out to avoid redefine warnings
 
 
@@ -94,9 +94,143 @@ typedef struct p_states {
     
      state_t    p_s;              
      int        p_time;           
+     int        p_childTime;      // p_time of terminated descendants, rolled up on their death
      int        *p_semAdd;        
      p_states   stateArray[3]; // Each of the three types of traps
                                 // is associated with two areas
+
+     int        p_pid;            // unique while alive, 0 when on the free list
+
+     int        p_grpID;          // process group (inherited from the parent)
+     struct pcb_t   *p_grpNext,    // circular membership list of the group
+            *p_grpPrev;
+     BOOL       p_suspended;      // parked by SUSPENDGROUP until RESUMEGROUP
+     unsigned int p_sigPending;   // signals posted by SIGNALGROUP, not yet read
+
+     state_t    *p_upcall;        // loaded into a new activation when we block (SPECUPCALL)
+
+     int        p_budget;         // CPU microseconds allowed per budget period, 0 = unlimited
+     int        p_budgetUsed;     // charged this period (to us, or us and our descendants)
+     int        p_budgetFlags;    // BUDGETSUBTREE, BUDGETKILL
+     int        p_budgetEpoch;    // period p_budgetUsed belongs to
+     int        p_throttles;      // times this budget parked a process
+     BOOL       p_throttled;      // parked on g_throttledQueue until replenished
+
+     int        p_dispatches;     // times the scheduler has given it the CPU
+     int        p_volSwitches;    // gave up the CPU itself (blocked or yielded)
+     int        p_involSwitches;  // preempted at the end of a quantum
+     int        p_readyTime;      // microseconds spent ready but not running
+     int        p_blockedTime[BLOCKCATS]; // microseconds blocked, by BLOCKSEM/BLOCKIO/BLOCKCLOCK
+     int        p_blockCat;       // why it is blocked right now, or NOTBLOCKED
+     int        p_stamp;          // TOD when it became ready or blocked
+     int        p_wakeClass;      // woken by this device class (LATCLOCK for SYS 7), or NOWAKE
  }  pcb_t, *pcb_PTR;
+
+// Filled in by GETTIMES
+typedef struct cputime_t {
+    int         c_self;           // p_time
+    int         c_children;       // terminated descendants' p_time
+} cputime_t;
+
+// One record per live process, filled in by SNAPSHOT
+typedef struct procsnap_t {
+    int         ps_pid;
+    int         ps_ppid;          // 0 for the root
+    int         ps_state;         // PSRUNNING, PSREADY, PSBLOCKED, ...
+    int         *ps_semAdd;       // what it is blocked on, or NULL
+    int         ps_device;        // index into the device semaphores, or NODEVICE
+    int         ps_time;          // p_time
+    int         ps_dispatches;    // p_dispatches
+    int         ps_grpID;
+} procsnap_t;
+
+// Filled in by GETSCHEDSTATS
+typedef struct schedstat_t {
+    int         s_dispatches;
+    int         s_volSwitches;
+    int         s_involSwitches;
+    int         s_readyTime;
+    int         s_blockedTime[BLOCKCATS];
+} schedstat_t;
+
+// One kernel tracepoint hit, READTRACE copies these out oldest first
+typedef struct traceev_t {
+    unsigned int t_tod;           // getTODLO() when it happened
+    int         t_type;           // TR_DISPATCH, TR_QUANTUM, ...
+    int         t_pid;            // process it happened to, 0 for none
+    unsigned int t_arg;           // depends on t_type, see const.h
+} traceev_t;
+
+// One disk sector written by the trace exporter, events oldest first
+typedef struct traceblk_t {
+    unsigned int b_magic;         // TRACEMAGIC
+    unsigned int b_seq;           // 0, 1, 2, ... in the order written
+    int         b_count;          // b_events in use
+    int         b_pad;
+    traceev_t   b_events[TRACEBLKEVENTS];
+} traceblk_t;
+
+// One profile histogram bucket, PROFREAD copies these out
+typedef struct profent_t {
+    int         pr_pid;           // 0 (with pr_pc 0) counts samples that found no free bucket
+    unsigned int pr_pc;           // where the process was when the sample was taken
+    int         pr_count;         // samples at that PC
+} profent_t;
+
+// Filled in by READLATENCY: log2 histograms per device class (lines 3-7, then the clock)
+typedef struct lathist_t {
+    unsigned int l_wake[LATCLASSES][LATBUCKETS];     // interrupt entry -> waiter made ready
+    unsigned int l_dispatch[LATCLASSES][LATBUCKETS]; // made ready -> dispatched
+} lathist_t;
+
+// Contention statistics of one semaphore, SEMTOP copies the worst ones out
+typedef struct semstat_t {
+    int         *ss_semAdd;       // which semaphore, NULL for an unused entry
+    int         ss_P;             // SYS 4s on it
+    int         ss_contended;     // of those, how many blocked
+    int         ss_waitTotal;     // ticks spent blocked, summed over every waiter
+    int         ss_waitMax;       // longest single wait
+    int         ss_holdTotal;     // ticks from a P to the same process' V (mutex use)
+    int         ss_holds;         // such P ... V pairs
+    int         ss_holder;        // PID that last got through a P, 0 if released
+    int         ss_holdStart;     // TOD it got through
+} semstat_t;
+
+// Use of one device (or terminal subdevice, or the pseudo-clock), DEVSTATS copies out MAXSEMA4 of them
+typedef struct devstat_t {
+    int         d_ops;            // operations completed (interrupts that woke a waiter)
+    int         d_errors;         // of those, how many ended in an error status
+    int         d_busyTime;       // ticks with at least one SYS 8 outstanding
+    int         d_idleTime;       // ticks with none
+    unsigned int d_depthTime;     // waiters * ticks, divide by busy + idle for the mean queue depth
+    int         d_outstanding;    // processes waiting on it right now
+    int         d_lastChange;     // TOD the above were last brought up to date
+} devstat_t;
+
+// Filled in by KERNELTIME, times in TOD ticks since boot (or the last reset)
+typedef struct ktime_t {
+    unsigned int k_time[KPATHS];  // spent in each kernel path, see KPPASSUP etc.
+    int         k_count[KPATHS];  // times each path was taken
+    unsigned int k_idle;          // waiting in scheduler()'s WAIT
+    unsigned int k_total;         // all of the above plus process time
+    unsigned int k_process;       // k_total less the nucleus and idle time
+} ktime_t;
+
+// Filled in by LOADAVG
+typedef struct loadavg_t {
+    unsigned int la_load[LOADAVGS]; // 1, 5 and 15 interval averages, LOADSHIFT fraction bits
+    int         la_runnable;      // ready, throttled and running at the last tick
+    int         la_softBlocked;   // waiting on I/O or the clock at the last tick
+    int         la_idle;          // percent of the last interval spent in WAIT
+    int         la_ticks;         // intervals sampled since boot
+} loadavg_t;
+
+// Filled in by GETBUDGET
+typedef struct budget_t {
+    int         b_budget;         // microseconds per period, 0 = unlimited
+    int         b_used;           // charged so far this period
+    int         b_flags;          // BUDGETSUBTREE, BUDGETKILL
+    int         b_throttles;      // times the budget ran out
+} budget_t;
  
 #endif
@@ -0,0 +1,164 @@
+/**************************************************************
+* FILENAME:		aslhash.c
+*
+* DESCRIPTION:	Hashed Active Semaphore List for JaeOS (host replay)
+*
+* NOTES:		A drop-in alternative to phase1/asl.c with the same
+*				asl.e interface, for comparing the two on recorded
+*				traces (make replay builds one replayer per ASL, see
+*				replay.c). It is not part of the nucleus.
+*
+*				Active descriptors are chained off ASLBUCKETS buckets
+*				hashed on the semaphore address, in no particular
+*				order, instead of one list sorted by address. Finding
+*				a semaphore costs a walk of its bucket only, whatever
+*				the number of active semaphores. The free list and
+*				the semdTable[MAXPROC] bound are as in asl.c.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/pcb.e"
+#include "../e/asl.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+#define ASLBUCKETS			32 		// a power of 2
+#define ASLHASH(semAdd)		((((unsigned long) (semAdd)) >> 2) & (ASLBUCKETS - 1))
+
+// Semaphore Descriptor
+typedef struct semd_t {
+	struct semd_t 	*s_next;		// next element in its bucket
+	int 			*s_semAdd;		// pointer to the semaphore
+	pcb_t 			*s_procQ;		// tail pointer to a process queue
+} semd_t;
+
+HIDDEN semd_t *buckets[ASLBUCKETS];
+HIDDEN semd_t *semdFree_h;
+
+//////////////////// FUNCTION DECLARATIONS ////////////////////
+/********************* Public Functions **********************/
+void initASL();
+int insertBlocked(int *semAdd, pcb_PTR p);
+pcb_PTR removeBlocked(int *semAdd);
+pcb_PTR outBlocked(pcb_PTR p);
+pcb_PTR headBlocked(int *semAdd);
+/********************* Private Functions *********************/
+HIDDEN semd_t **findSemd(int *semAdd);
+HIDDEN pcb_PTR releaseIfEmpty(semd_t **link, pcb_PTR p);
+////////////////////// End Declarations ///////////////////////
+
+
+/* ---- initASL() ---------------------------------------------
+* Description:	every descriptor free, every bucket empty
+* --------------------------------------- end initASL() ---- */
+void initASL(){
+	static semd_t semdTable[MAXPROC];
+	int i;
+
+	semdFree_h = NULL;
+	for(i = 0; i < MAXPROC; i++){
+		semdTable[i].s_next = semdFree_h;
+		semdFree_h = &(semdTable[i]);
+	}
+	for(i = 0; i < ASLBUCKETS; i++){
+		buckets[i] = NULL;
+	}
+}
+
+/* ---- insertBlocked() ---------------------------------------
+* Description:	as in asl.c: TRUE only if no descriptor was free
+* --------------------------------- end insertBlocked() ---- */
+int insertBlocked(int *semAdd, pcb_PTR p){
+	semd_t **link = findSemd(semAdd);
+	semd_t *semd = *link;
+
+	if(semd == NULL){
+		if(semdFree_h == NULL){
+			return (TRUE);
+		}
+		semd = semdFree_h;
+		semdFree_h = semd->s_next;
+		semd->s_semAdd = semAdd;
+		semd->s_procQ = mkEmptyProcQ();
+		semd->s_next = buckets[ASLHASH(semAdd)];	// at the front of its bucket
+		buckets[ASLHASH(semAdd)] = semd;
+	}
+	insertProcQ(&(semd->s_procQ), p);
+	p->p_semAdd = semAdd;
+	return (FALSE);
+}
+
+/* ---- removeBlocked() ---------------------------------------
+* Description:	as in asl.c
+* --------------------------------- end removeBlocked() ---- */
+pcb_PTR removeBlocked(int *semAdd){
+	semd_t **link = findSemd(semAdd);
+
+	if(*link == NULL){
+		return (NULL);
+	}
+	return (releaseIfEmpty(link, removeProcQ(&((*link)->s_procQ))));
+}
+
+/* ---- outBlocked() ------------------------------------------
+* Description:	as in asl.c
+* ------------------------------------ end outBlocked() ---- */
+pcb_PTR outBlocked(pcb_PTR p){
+	semd_t **link = findSemd(p->p_semAdd);
+
+	if(*link == NULL){
+		return (NULL);
+	}
+	return (releaseIfEmpty(link, outProcQ(&((*link)->s_procQ), p)));
+}
+
+/* ---- headBlocked() -----------------------------------------
+* Description:	as in asl.c
+* ----------------------------------- end headBlocked() ---- */
+pcb_PTR headBlocked(int *semAdd){
+	semd_t **link = findSemd(semAdd);
+
+	if(*link == NULL){
+		return (NULL);
+	}
+	return (headProcQ((*link)->s_procQ));
+}
+
+/* ---- findSemd() ----------------------------------------
+* Parameters: 	int *semAdd
+* Type: 		Private
+* Return:		the link pointing at semAdd's descriptor, or at
+*				NULL at the end of its bucket if it is not active
+* ---------------------------------- end findSemd() ---- */
+HIDDEN semd_t **findSemd(int *semAdd){
+	semd_t **link = &(buckets[ASLHASH(semAdd)]);
+
+	while((*link != NULL) && ((*link)->s_semAdd != semAdd)){
+		link = &((*link)->s_next);
+	}
+	return (link);
+}
+
+/* ---- releaseIfEmpty() ----------------------------------------
+* Parameters: 	the link to a descriptor, the ProcBlk just taken off it
+* Type: 		Private
+* Return:		p
+* Description:
+*	Unchain the descriptor and free it if nobody is left
+*	waiting on its semaphore.
+* ---------------------------------- end releaseIfEmpty() ---- */
+HIDDEN pcb_PTR releaseIfEmpty(semd_t **link, pcb_PTR p){
+	semd_t *semd = *link;
+
+	if((p != NULL) && emptyProcQ(semd->s_procQ)){
+		*link = semd->s_next;
+		semd->s_next = semdFree_h;
+		semdFree_h = semd;
+	}
+	return (p);
+}
@@ -0,0 +1,180 @@
+/*********************************HOSTBENCH.C*******************************
+ *
+ *	Benchmark program for the host build of the JaeOS nucleus.
+ *
+ *	The same kind of workload as phase2/p2bench.c, run natively
+ *	against the mock uARM library so the nucleus can be timed in
+ *	wall clock terms and profiled with perf:
+ *		perf record ./kernel.host && perf report
+ *
+ *	Prints one line per benchmark:
+ *		name   operations   ns per operation   ticks per operation
+ *	where ticks are the simulated clock's (see uarm/libuarm.c).
+ *
+ *	The root process test() is started by the nucleus as usual;
+ *	main() just powers the simulated machine on.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "uarm/libuarm.h"
+
+
+#define QPAGE			1024
+#define ROUNDS			100000		/* hand offs per switch benchmark */
+#define CLOCKROUNDS		50			/* pseudo-clock waits */
+#define COMPUTEROUNDS	1000		/* slices of computing, a quantum or so each */
+#define PRINTCHR		2
+#define BYTELEN			8
+#define TERM0ADDR		DEV_REG_ADDR(IL_TERMINAL, 0)
+
+extern void kernelMain();			/* initial.c's main(), renamed */
+
+
+int		ready=0,		/* partner has started */
+		done=0,			/* partner has finished */
+		pingA=0,		/* root's half of a ping-pong */
+		pingB=0;		/* partner's half of a ping-pong */
+
+state_t	partnerState;	/* reused for every partner, one at a time */
+
+void	vpPartner(), yieldPartner(), computePartner();
+
+
+/* host wall clock, in ns */
+unsigned long long wallNs() {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long) now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/* one line of the results table */
+void report(char *name, unsigned int ops, unsigned long long ns, unsigned long long ticks) {
+	printf("%-16s %8u %10.1f %10llu\n", name, ops, (double) ns / ops, ticks / ops);
+}
+
+/* print on terminal 0 through SYS 8, a character at a time */
+void print(char *msg) {
+	termreg_t *base = (termreg_t *) (TERM0ADDR);
+
+	while (*msg != '\0') {
+		base->transm_command = PRINTCHR | (((unsigned int) *msg) << BYTELEN);
+		if ((SYSCALL(WAITIO, IL_TERMINAL, 0, 0) & DEVSTATUSMASK) != CHARDONE)
+			PANIC();
+		msg++;
+	}
+}
+
+/* start body() as the partner process and wait until it is running */
+void startPartner(void (*body)()) {
+	partnerState.pc = (unsigned int) (unsigned long) body;
+	SYSCALL(CREATEPROCESS, (unsigned int) (unsigned long) &partnerState, 0, 0);
+	SYSCALL(PASSEREN, (unsigned int) (unsigned long) &ready, 0, 0);
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	unsigned long long	ns, ticks;
+	int					i;
+
+	printf("hostbench starts\n");
+	printf("%-16s %8s %10s %10s\n", "benchmark", "ops", "ns/op", "ticks/op");
+
+	STST(&partnerState);
+	partnerState.sp = partnerState.sp - QPAGE;
+	partnerState.cpsr = ALLOFF | SYSMODE;
+
+	/* V+P ping-pong: every hand off is a V and a P */
+	startPartner(vpPartner);
+	ns = wallNs();
+	ticks = uarmClock();
+	for (i = 0; i < ROUNDS; i++) {
+		SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &pingB, 0, 0);
+		SYSCALL(PASSEREN, (unsigned int) (unsigned long) &pingA, 0, 0);
+	}
+	report("V+P switch", 2 * ROUNDS, wallNs() - ns, uarmClock() - ticks);
+	SYSCALL(PASSEREN, (unsigned int) (unsigned long) &done, 0, 0);
+
+	/* YIELD: round robin between the two of us */
+	startPartner(yieldPartner);
+	ns = wallNs();
+	ticks = uarmClock();
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELD, 0, 0, 0);
+	report("YIELD switch", 2 * ROUNDS, wallNs() - ns, uarmClock() - ticks);
+	SYSCALL(PASSEREN, (unsigned int) (unsigned long) &done, 0, 0);
+
+	/* time slicing: both of us compute, the quantum timer switches */
+	startPartner(computePartner);
+	ns = wallNs();
+	ticks = uarmClock();
+	for (i = 0; i < COMPUTEROUNDS; i++)
+		uarmCompute(QUANTUM);
+	report("compute", COMPUTEROUNDS, wallNs() - ns, uarmClock() - ticks);
+	SYSCALL(PASSEREN, (unsigned int) (unsigned long) &done, 0, 0);
+
+	/* SYS 7: every wait idles the machine until the next tick */
+	ns = wallNs();
+	ticks = uarmClock();
+	for (i = 0; i < CLOCKROUNDS; i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	report("WAITCLOCK", CLOCKROUNDS, wallNs() - ns, uarmClock() - ticks);
+
+	/* SYS 8: a character per terminal interrupt */
+	ns = wallNs();
+	ticks = uarmClock();
+	print("hostbench terminal 0\n");
+	report("WAITIO char", 21, wallNs() - ns, uarmClock() - ticks);
+
+	printf("hostbench finished\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* partner of the V+P ping-pong */
+void vpPartner() {
+	int i;
+
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &ready, 0, 0);
+	for (i = 0; i < ROUNDS; i++) {
+		SYSCALL(PASSEREN, (unsigned int) (unsigned long) &pingB, 0, 0);
+		SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &pingA, 0, 0);
+	}
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* partner of the YIELD benchmark */
+void yieldPartner() {
+	int i;
+
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &ready, 0, 0);
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELD, 0, 0, 0);
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* partner of the time slicing benchmark */
+void computePartner() {
+	int i;
+
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &ready, 0, 0);
+	for (i = 0; i < COMPUTEROUNDS; i++)
+		uarmCompute(QUANTUM);
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+int main() {
+	return (uarmRun(kernelMain));
+}
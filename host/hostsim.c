@@ -0,0 +1,373 @@
+/*********************************HOSTSIM.C*******************************
+ *
+ *	Discrete-event workload simulator for the host build of the
+ *	JaeOS nucleus.
+ *
+ *	Runs a synthetic workload on the nucleus over the simulated
+ *	clock of the mock uARM library and reports, per run:
+ *		throughput		jobs per million ticks
+ *		p50 p90 p99 max	job latency in ticks
+ *		csw/job			context switches (SYS 24) per job
+ *		idle%			time spent in WAIT (SYS 32)
+ *
+ *	Every worker process runs jobs back to back. A job is a CPU
+ *	burst, then with probability share% a critical section on one
+ *	semaphore all workers share, then with probability io% a
+ *	printer operation through SYS 8 (workers take turns on the 8
+ *	printers, one P/V mutex each). Bursts and device service
+ *	times are drawn from the chosen distribution.
+ *
+ *	Every parameter takes a comma separated list, and the runs
+ *	sweep every combination in parallel, one host process each:
+ *		./kernel.sim procs=2,4,8,16 io=10,50 -j 8
+ *	The policy under test is the nucleus itself: build it again
+ *	with other flags and compare, e.g.
+ *		make clean sim POLICYFLAGS=-DQUANTUM=2000
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "uarm/libuarm.h"
+
+
+#define QPAGE			1024
+#define PRINTCHR		2
+#define SIMMAXJOBS		200000		/* latencies kept per run */
+#define SIMVALUES		16			/* values per swept parameter */
+#define SIMPARAMS		(sizeof(params) / sizeof(params[0]))
+#define DIST_CONST		0
+#define DIST_EXP		1
+#define DIST_UNIFORM	2
+
+extern void kernelMain();			/* initial.c's main(), renamed */
+
+
+/* one workload parameter and the values it sweeps */
+typedef struct simparam_t {
+	char			*s_name;
+	unsigned int	s_default;
+	char			*s_help;
+	int				s_count;
+	unsigned int	s_values[SIMVALUES];
+} simparam_t;
+
+/* what one run measured, sent back to the parent through a pipe */
+typedef struct simresult_t {
+	int				r_ok;
+	unsigned int	r_jobs;
+	unsigned long long r_ticks;
+	unsigned int	r_p50, r_p90, r_p99, r_max;
+	unsigned int	r_switches;
+	unsigned int	r_idle;			/* percent */
+} simresult_t;
+
+simparam_t params[] = {
+	{"procs",	4,		"worker processes (at most MAXPROC - 1)"},
+	{"jobs",	200,	"jobs per worker"},
+	{"burst",	2000,	"mean CPU burst per job, ticks"},
+	{"cs",		500,	"mean critical section, ticks"},
+	{"share",	20,		"percent of jobs entering the critical section"},
+	{"io",		30,		"percent of jobs doing a printer operation"},
+	{"svc",		5000,	"mean device service time, ticks"},
+	{"dist",	DIST_EXP, "const, exp or uniform"},
+	{"kcost",	0,		"ticks charged per kernel entry"},
+	{"seed",	1,		"random seed"},
+};
+
+char	*distNames[] = {"const", "exp", "uniform"};
+
+/* the run in progress (each run is its own host process) */
+unsigned int	config[SIMPARAMS];
+enum { PROCS, JOBS, BURST, CS, SHARE, IO, SVC, DIST, KCOST, SEED };
+
+unsigned long long	randomState;
+unsigned int		latency[SIMMAXJOBS];
+unsigned int		jobCount;
+unsigned int		switches;
+unsigned long long	startTick, endTick;
+ktime_t				kernelTimes;
+
+int		done=0,				/* a worker has finished */
+		shared=1,			/* the critical section */
+		printerMutex[DEV_PER_INT] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+state_t	workerState;
+
+void	worker(unsigned int index);
+
+
+/* xorshift64*, uniform in [0, 1) */
+double uniform() {
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+	return ((randomState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* a time with the given mean, at least one tick */
+unsigned int sample(unsigned int mean) {
+	double ticks = mean;
+
+	if (config[DIST] == DIST_EXP)
+		ticks = -log(1.0 - uniform()) * mean;
+	else if (config[DIST] == DIST_UNIFORM)
+		ticks = uniform() * 2 * mean;
+	return ((ticks < 1) ? 1 : (unsigned int) ticks);
+}
+
+/* TRUE with the given percent probability */
+int chance(unsigned int percent) {
+	return ((uniform() * 100) < percent);
+}
+
+/* uarmServiceTime() hook: every device operation */
+unsigned int deviceTicks(int line, int device) {
+	return (sample(config[SVC]));
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	int i;
+
+	STST(&workerState);
+	workerState.cpsr = ALLOFF | SYSMODE;
+	workerState.pc = (unsigned int) (unsigned long) worker;
+
+	startTick = uarmClock();
+	for (i = 0; i < config[PROCS]; i++) {
+		workerState.a1 = i;
+		workerState.sp = workerState.sp - QPAGE;	/* names the worker's host stack */
+		SYSCALL(CREATEPROCESS, (unsigned int) (unsigned long) &workerState, 0, 0);
+	}
+	for (i = 0; i < config[PROCS]; i++)
+		SYSCALL(PASSEREN, (unsigned int) (unsigned long) &done, 0, 0);
+	endTick = uarmClock();
+
+	SYSCALL(KERNELTIME, (unsigned int) (unsigned long) &kernelTimes, FALSE, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* one worker: jobs back to back, then its switch count */
+void worker(unsigned int index) {
+	int					device = index % DEV_PER_INT;
+	dtpreg_t			*printer = (dtpreg_t *) DEV_REG_ADDR(IL_PRINTER, device);
+	unsigned long long	start;
+	schedstat_t			stats;
+	int					j;
+
+	for (j = 0; j < config[JOBS]; j++) {
+		start = uarmClock();
+		uarmCompute(sample(config[BURST]));
+
+		if (chance(config[SHARE])) {
+			SYSCALL(PASSEREN, (unsigned int) (unsigned long) &shared, 0, 0);
+			uarmCompute(sample(config[CS]));
+			SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &shared, 0, 0);
+		}
+
+		if (chance(config[IO])) {
+			SYSCALL(PASSEREN, (unsigned int) (unsigned long) &printerMutex[device], 0, 0);
+			printer->data0 = '.';
+			printer->command = PRINTCHR;
+			SYSCALL(WAITIO, IL_PRINTER, device, 0);
+			SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &printerMutex[device], 0, 0);
+		}
+
+		if (jobCount < SIMMAXJOBS)
+			latency[jobCount++] = (unsigned int) (uarmClock() - start);
+	}
+
+	SYSCALL(GETSCHEDSTATS, 0, (unsigned int) (unsigned long) &stats, 0);
+	switches += stats.s_volSwitches + stats.s_involSwitches;
+	SYSCALL(VERHOGEN, (unsigned int) (unsigned long) &done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* qsort() order for latencies */
+int byTicks(const void *a, const void *b) {
+	unsigned int x = *((const unsigned int *) a), y = *((const unsigned int *) b);
+
+	return ((x > y) - (x < y));
+}
+
+/* power on one machine with config[] and measure it */
+simresult_t simulate() {
+	simresult_t	result;
+
+	memset(&result, 0, sizeof(result));
+	randomState = (config[SEED] * 0x9E3779B97F4A7C15ULL) | 1;
+	uarmQuiet(TRUE);
+	uarmServiceTime(deviceTicks);
+	uarmKernelCost(config[KCOST]);
+
+	result.r_ok = (uarmRun(kernelMain) == 0) && (jobCount > 0);
+	if (!result.r_ok)
+		return (result);
+
+	qsort(latency, jobCount, sizeof(latency[0]), byTicks);
+	result.r_jobs = jobCount;
+	result.r_ticks = endTick - startTick;
+	result.r_p50 = latency[((jobCount - 1) * 50) / 100];
+	result.r_p90 = latency[((jobCount - 1) * 90) / 100];
+	result.r_p99 = latency[((jobCount - 1) * 99) / 100];
+	result.r_max = latency[jobCount - 1];
+	result.r_switches = switches;
+	if (kernelTimes.k_total != 0)
+		result.r_idle = (unsigned int) ((100ULL * kernelTimes.k_idle) / kernelTimes.k_total);
+	return (result);
+}
+
+
+/* point's value of every parameter, the last one varying fastest */
+void pointConfig(int point) {
+	int i;
+
+	for (i = SIMPARAMS - 1; i >= 0; i--) {
+		config[i] = params[i].s_values[point % params[i].s_count];
+		point = point / params[i].s_count;
+	}
+}
+
+/* name=v1,v2,... into its parameter, FALSE if it is not one */
+int parseParam(char *arg) {
+	char	*value = strchr(arg, '=');
+	int		i, d;
+
+	if (value == NULL)
+		return (FALSE);
+	*value++ = '\0';
+	for (i = 0; i < SIMPARAMS; i++) {
+		if (strcmp(arg, params[i].s_name) != 0)
+			continue;
+		params[i].s_count = 0;
+		for (value = strtok(value, ","); value != NULL; value = strtok(NULL, ",")) {
+			if (params[i].s_count == SIMVALUES)
+				return (FALSE);
+			params[i].s_values[params[i].s_count] = strtoul(value, NULL, 0);
+			for (d = 0; (i == DIST) && (d < 3); d++)
+				if (strcmp(value, distNames[d]) == 0)
+					params[i].s_values[params[i].s_count] = d;
+			params[i].s_count++;
+		}
+		return (params[i].s_count > 0);
+	}
+	return (FALSE);
+}
+
+void usage() {
+	int i;
+
+	fprintf(stderr, "usage: kernel.sim [-j runs at once] [name=value[,value...]]...\n");
+	for (i = 0; i < SIMPARAMS; i++)
+		fprintf(stderr, "  %-6s %6u  %s\n", params[i].s_name, params[i].s_default, params[i].s_help);
+	exit(2);
+}
+
+/* one line of the results table */
+void report(simresult_t *r) {
+	int i;
+
+	for (i = 0; i < SIMPARAMS; i++) {
+		if (i == DIST)
+			printf("%-8s", distNames[config[i] % 3]);
+		else
+			printf("%-8u", config[i]);
+	}
+	if (!r->r_ok) {
+		printf("failed\n");
+		return;
+	}
+	printf("%10.1f %8u %8u %8u %8u %8.2f %6u\n",
+		(r->r_jobs * 1000000.0) / r->r_ticks, r->r_p50, r->r_p90, r->r_p99, r->r_max,
+		(double) r->r_switches / r->r_jobs, r->r_idle);
+}
+
+
+int main(int argc, char *argv[]) {
+	int			parallel = sysconf(_SC_NPROCESSORS_ONLN);
+	int			points = 1, next = 0, running = 0, point, i, status;
+	int			*pipes;
+	pid_t		*pids, pid;
+	simresult_t	*results;
+
+	for (i = 0; i < SIMPARAMS; i++) {
+		params[i].s_values[0] = params[i].s_default;
+		params[i].s_count = 1;
+	}
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+			parallel = atoi(argv[++i]);
+		else if (!parseParam(argv[i]))
+			usage();
+	}
+	for (i = 0; i < params[PROCS].s_count; i++)
+		if ((params[PROCS].s_values[i] == 0) || (params[PROCS].s_values[i] >= MAXPROC))
+			usage();
+	for (i = 0; i < SIMPARAMS; i++)
+		points = points * params[i].s_count;
+	if (parallel < 1)
+		parallel = 1;
+
+	pipes = calloc(points, sizeof(int));
+	pids = calloc(points, sizeof(pid_t));
+	results = calloc(points, sizeof(simresult_t));
+
+	/* keep up to parallel runs going, each in its own process */
+	while ((next < points) || (running > 0)) {
+		if ((next < points) && (running < parallel)) {
+			int fds[2];
+
+			fflush(stdout);
+			if (pipe(fds) != 0)
+				return (1);
+			pid = fork();
+			if (pid == 0) {
+				simresult_t result;
+
+				close(fds[0]);
+				pointConfig(next);
+				result = simulate();
+				write(fds[1], &result, sizeof(result));
+				_exit(0);
+			}
+			close(fds[1]);
+			pipes[next] = fds[0];
+			pids[next] = pid;
+			next++;
+			running++;
+			continue;
+		}
+
+		pid = wait(&status);
+		for (point = 0; point < next; point++) {
+			if (pids[point] == pid) {
+				if (read(pipes[point], &results[point], sizeof(simresult_t)) != sizeof(simresult_t))
+					results[point].r_ok = FALSE;
+				close(pipes[point]);
+				running--;
+			}
+		}
+	}
+
+	printf("# QUANTUM=%d, %d runs\n", QUANTUM, points);
+	for (i = 0; i < SIMPARAMS; i++)
+		printf("%-8s", params[i].s_name);
+	printf("%10s %8s %8s %8s %8s %8s %6s\n", "jobs/Mt", "p50", "p90", "p99", "max", "csw/job", "idle%");
+	for (point = 0; point < points; point++) {
+		pointConfig(point);
+		report(&results[point]);
+	}
+	return (0);
+}
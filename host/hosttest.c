@@ -0,0 +1,644 @@
+/*********************************HOSTTEST.C*******************************
+ *
+ *	Test program for the host build of the JaeOS nucleus.
+ *
+ *	Checks the SYS calls that came after the original eight, which
+ *	p2test does not reach, natively against the mock uARM library.
+ *
+ *	The root process test() runs one section per service, each
+ *	starting its own children and cleaning them up, and prints
+ *	"<section> ok" as each one passes. Like p2test it aborts
+ *	(PANIC) as soon as a check fails, after saying which one.
+ *
+ *	Built by "make test" in host/ (kernel.test).
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "uarm/libuarm.h"
+
+
+#define QPAGE			1024
+#define CHILDSTACKS		32			/* sps handed out in turn, a page apart */
+#define YIELDS			10			/* round trips to let everyone else run */
+#define ROOTGROUP		0			/* where the root and its children start */
+#define TESTGROUP		1
+#define BUDGETGROUP		2
+#define BUDGETUS		QUANTUM		/* a quantum of CPU per budget period */
+#define SPINTICKS		(6 * BUDGETUS)	/* so at least three periods */
+#define CREATEGROUP		3
+#define FILLGROUP		4
+#define CREATORS		(MAXCREATEWAIT + 1)			/* one more than may wait */
+#define FILLERS			(MAXPROC - 1 - CREATORS)	/* and the rest of the pool */
+#define CHILDTICKS		(10 * QUANTUM)	/* what each timed child computes */
+#define TIMEDLEVELS		2				/* a child and a grandchild */
+#define LOADTICKS		5				/* intervals the load is sampled over */
+#define LINELEN			80				/* a kernel log line we look for */
+#define SIGA			0x00000005
+#define SIGB			0x00000002
+
+/* pointers go through SYS call arguments as on uARM */
+#define PRINTCHR		2
+#define BYTELEN			8
+#define TERM0ADDR		DEV_REG_ADDR(IL_TERMINAL, 0)
+#define TERM0WRITEINDEX	(((LINENUMSEVEN - DEVICEOFFSET) * TOTALDEVICES) + TOTALDEVICES)	/* its transmitter's semaphore */
+#define DEVLINE			"hosttest terminal 0\n"
+#define ADDR(p)			((unsigned int) (unsigned long) (p))
+
+extern void kernelMain();			/* initial.c's main(), renamed */
+
+
+int		ready=0,		/* a child has started */
+		done=0,			/* a child has finished */
+		gate=0,			/* children wait here until the root lets them go */
+		park=0,			/* where children wait to be terminated */
+		quit=0,			/* children wait here to terminate themselves */
+		contended=0;	/* one child blocks here, and nobody else */
+
+int		rootPid,
+		memberPid,		/* the child started last */
+		killedPid,		/* the budget holder BUDGETKILL got rid of */
+		clockPid;		/* a child waiting on the pseudo-clock */
+
+int		spins,			/* a spinning member's progress */
+		woke,			/* a member got past where it waited */
+		after;			/* a member lived through its own TERMINATEGROUP */
+unsigned int	sigs[2];	/* what a member's two GETSIGNALS returned */
+int		probeResult;	/* what a child's SETBUDGET of the root returned */
+budget_t	budget;		/* a spinner's GETBUDGET when it finished */
+
+state_t	kidState[CREATORS];	/* what each creator asks SYS 1 for */
+int		created[CREATORS];	/* and what it got */
+int		arrival[CREATORS], arrivals;	/* creators in the order they asked */
+int		admitted[CREATORS], admissions;	/* their children in the order they started */
+
+int		timedDone[TIMEDLEVELS];	/* V'd by the timed child n levels above the bottom */
+
+state_t		childState;	/* reused for every child */
+unsigned int	rootSp;
+int			nextStack;
+
+procsnap_t	snap[MAXPROC];
+int			snapCount;
+traceev_t	events[TRACESIZE];
+semstat_t	stats[SEMSTATSIZE];
+devstat_t	devices[MAXSEMA4];
+loadavg_t	load;
+char		logText[KLOGSIZE + 1];
+
+void	spinMember(), selfSuspender(), gateMember(), signalMember(),
+		groupKiller(), parkChild(), budgetProbe(), budgetSpinner(),
+		budgetKiller(), computeChild(), filler(), creator(), createdKid(),
+		timedChild(), clockMember(), contender(), loadSpinner();
+
+
+/* stop everything if a check failed */
+void check(BOOL ok, char *what) {
+	if (!ok) {
+		printf("hosttest: %s\n", what);
+		PANIC();
+	}
+}
+
+/* load s to run body(arg) on a stack of its own */
+void prepare(state_t *s, void (*body)(), int arg) {
+	*s = childState;
+	s->pc = ADDR(body);
+	s->a1 = arg;
+	s->sp = rootSp - ((nextStack + 1) * QPAGE);
+	nextStack = (nextStack + 1) % CHILDSTACKS;
+}
+
+/* start body(arg) as a child of the caller, in the caller's group */
+void spawn(void (*body)(), int arg) {
+	state_t s;
+
+	prepare(&s, body, arg);
+	check(SYSCALL(CREATEPROCESS, ADDR(&s), FALSE, 0) == SUCCESS, "SYS 1 failed");
+}
+
+/* let every ready process run for a while */
+void yieldSome() {
+	int i;
+
+	for (i = 0; i < YIELDS; i++)
+		SYSCALL(YIELD, 0, 0, 0);
+}
+
+/* SNAPSHOT, and the record of pid in it (NULL if it is gone) */
+procsnap_t *snapOf(int pid) {
+	int i;
+
+	snapCount = SYSCALL(SNAPSHOT, ADDR(&snap[0]), MAXPROC, 0);
+	for (i = 0; i < snapCount; i++)
+		if (snap[i].ps_pid == pid)
+			return (&snap[i]);
+	return (NULL);
+}
+
+/* pid's state in a fresh SNAPSHOT, -1 if it is gone */
+int stateOf(int pid) {
+	procsnap_t *record = snapOf(pid);
+
+	return ((record == NULL) ? -1 : record->ps_state);
+}
+
+/* live processes in group grpID, from a fresh SNAPSHOT */
+int groupSize(int grpID) {
+	int i, n = 0;
+
+	snapOf(0);
+	for (i = 0; i < snapCount; i++)
+		if (snap[i].ps_grpID == grpID)
+			n++;
+	return (n);
+}
+
+
+/* SYS 10-15: suspend, resume, signal and terminate a group */
+void testGroups() {
+	int before;
+
+	check((int) SYSCALL(SUSPENDGROUP, MAXGROUPS, 0, 0) == FAILURE, "SUSPENDGROUP of no group");
+
+	/* another group: a ready member is parked, and comes back */
+	spawn(spinMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	check(SYSCALL(SUSPENDGROUP, TESTGROUP, 0, 0) == SUCCESS, "SUSPENDGROUP failed");
+	before = spins;
+	yieldSome();
+	check(spins == before, "suspended member ran");
+	check(stateOf(memberPid) == PSSUSPENDED, "suspended member not PSSUSPENDED");
+	check(SYSCALL(RESUMEGROUP, TESTGROUP, 0, 0) == SUCCESS, "RESUMEGROUP failed");
+	yieldSome();
+	check(spins > before, "resumed member did not run");
+
+	/* our own group: the member parks itself */
+	spawn(selfSuspender, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	yieldSome();
+	check((woke == 0) && (stateOf(memberPid) == PSSUSPENDED), "self-suspended member ran");
+	SYSCALL(RESUMEGROUP, TESTGROUP, 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	check(woke == 1, "self-suspended member not resumed");
+
+	/* a blocked member woken while suspended stays parked until RESUMEGROUP */
+	woke = 0;
+	spawn(gateMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	yieldSome();
+	check(stateOf(memberPid) == PSBLOCKED, "gate member not blocked");
+	SYSCALL(SUSPENDGROUP, TESTGROUP, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&gate), 0, 0);
+	yieldSome();
+	check((woke == 0) && (stateOf(memberPid) == PSSUSPENDED), "member woken while suspended ran");
+	SYSCALL(RESUMEGROUP, TESTGROUP, 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	check(woke == 1, "member woken while suspended not resumed");
+
+	/* signals add up until GETSIGNALS collects and clears them */
+	spawn(signalMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	SYSCALL(SIGNALGROUP, TESTGROUP, SIGA, 0);
+	SYSCALL(SIGNALGROUP, TESTGROUP, SIGB, 0);
+	SYSCALL(VERHOGEN, ADDR(&gate), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	check(sigs[0] == (SIGA | SIGB), "GETSIGNALS lost a signal");
+	check(sigs[1] == 0, "GETSIGNALS did not clear");
+	check(SYSCALL(GETSIGNALS, 0, 0, 0) == 0, "signal reached another group");
+
+	/* TERMINATEGROUP from outside takes every member, the caller survives */
+	check(SYSCALL(TERMINATEGROUP, TESTGROUP, 0, 0) == SUCCESS, "TERMINATEGROUP failed");
+	check((groupSize(TESTGROUP) == 0) && (snapCount == 1), "TERMINATEGROUP left members");
+
+	/* and from inside, the caller and its child with it */
+	spawn(groupKiller, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	yieldSome();
+	check(after == 0, "member survived its own TERMINATEGROUP");
+	check(snapOf(0) == NULL && (snapCount == 1), "TERMINATEGROUP from inside left members");
+
+	printf("groups ok\n");
+}
+
+/* SYS 20-21: a budget throttles, is replenished, and kills a subtree */
+void testBudgets() {
+	int i;
+
+	/* only the caller and its descendants, only the two flags */
+	check((int) SYSCALL(SETBUDGET, 0, BUDGETUS, BUDGETKILL << 1) == FAILURE, "SETBUDGET took a bad flag");
+	spawn(budgetProbe, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	check(probeResult == FAILURE, "SETBUDGET of a non-descendant");
+	check(SYSCALL(SETBUDGET, memberPid, BUDGETUS, 0) == SUCCESS, "SETBUDGET of a child failed");
+	check(SYSCALL(SETBUDGET, memberPid, 0, 0) == SUCCESS, "SETBUDGET could not remove a budget");
+
+	/* a spinner over its budget is parked until the next period */
+	spawn(budgetSpinner, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	for (i = 0; (i < BUDGETPERIOD) && (stateOf(memberPid) != PSTHROTTLED); i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	check(stateOf(memberPid) == PSTHROTTLED, "spinner over budget not throttled");
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	/* a period can give up to a quantum over the budget */
+	check(budget.b_throttles >= (SPINTICKS / (BUDGETUS + QUANTUM)) - 1, "spinner throttled too few times");
+	check(SYSCALL(TERMINATEGROUP, BUDGETGROUP, 0, 0) == SUCCESS, "TERMINATEGROUP failed");
+
+	/* with BUDGETKILL the holder goes, along with the child that spent it */
+	spawn(budgetKiller, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	for (i = 0; (i < 2 * BUDGETPERIOD) && (stateOf(memberPid) != -1); i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	check((stateOf(memberPid) == -1) && (groupSize(BUDGETGROUP) == 0), "BUDGETKILL subtree not killed");
+	killedPid = memberPid;
+
+	printf("budgets ok\n");
+}
+
+/* SYS 1 with A3 TRUE: creators wait for a ProcBlk in order, up to MAXCREATEWAIT */
+void testAdmission() {
+	int i;
+
+	for (i = 0; i < FILLERS; i++)
+		spawn(filler, 0);
+	for (i = 0; i < CREATORS; i++)
+		spawn(creator, i);
+	yieldSome();
+
+	/* the pool is full: all but the last creator wait, the last fails */
+	check(arrivals == CREATORS, "creators did not all ask");
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	check(created[arrival[CREATORS - 1]] == FAILURE, "SYS 1 waited past MAXCREATEWAIT");
+
+	/* a creator admitted while its group is suspended gets a parked child */
+	SYSCALL(SUSPENDGROUP, CREATEGROUP, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&quit), 0, 0);
+	yieldSome();
+	check(admissions == 0, "child of a suspended creator ran");
+	snapOf(0);
+	for (i = 0; (i < snapCount) && ((snap[i].ps_grpID != CREATEGROUP) || (snap[i].ps_state != PSSUSPENDED)); i++)
+		;
+	check(i < snapCount, "admitted creator not parked");
+	SYSCALL(RESUMEGROUP, CREATEGROUP, 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+
+	/* every freed ProcBlk goes to the creator that asked first */
+	for (i = 1; i < CREATORS - 1; i++) {
+		SYSCALL(VERHOGEN, ADDR(&quit), 0, 0);
+		SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+		SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	}
+	check(admissions == CREATORS - 1, "waiting creators not all admitted");
+	for (i = 0; i < CREATORS - 1; i++)
+		check((admitted[i] == arrival[i]) && (created[arrival[i]] == SUCCESS), "creators admitted out of order");
+
+	SYSCALL(TERMINATEGROUP, CREATEGROUP, 0, 0);
+	SYSCALL(TERMINATEGROUP, FILLGROUP, 0, 0);
+	check((snapOf(0) == NULL) && (snapCount == 1), "admission test left processes");
+
+	printf("admission ok\n");
+}
+
+/* SYS 22: a dead child's time, and its child's, is rolled up into ours */
+void testTimes() {
+	cputime_t before, times;
+
+	SYSCALL(GETTIMES, ADDR(&before), 0, 0);
+	spawn(timedChild, TIMEDLEVELS - 1);
+	SYSCALL(PASSEREN, ADDR(&timedDone[TIMEDLEVELS - 1]), 0, 0);
+	SYSCALL(GETTIMES, ADDR(&times), 0, 0);
+	check(times.c_children - before.c_children >= TIMEDLEVELS * CHILDTICKS, "GETTIMES missed a dead descendant");
+	check((times.c_self >= before.c_self) && (times.c_self <= (int) SYSCALL(GETCPUTIME, 0, 0, 0)), "GETTIMES own time is not SYS 6's");
+
+	printf("times ok\n");
+}
+
+/* print on terminal 0 through SYS 8, a character at a time */
+void print(char *msg) {
+	termreg_t *base = (termreg_t *) (TERM0ADDR);
+
+	while (*msg != '\0') {
+		base->transm_command = PRINTCHR | (((unsigned int) *msg) << BYTELEN);
+		check((SYSCALL(WAITIO, IL_TERMINAL, 0, 0) & DEVSTATUSMASK) == CHARDONE, "terminal 0 failed");
+		msg++;
+	}
+}
+
+/* SYS 23: what every process is doing, and who its parent is */
+void testSnapshot() {
+	procsnap_t *record;
+
+	spawn(gateMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	spawn(clockMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	yieldSome();
+
+	record = snapOf(rootPid);
+	check(snapCount == 3, "SNAPSHOT count wrong");
+	check((record != NULL) && (record->ps_state == PSRUNNING) && (record->ps_ppid == 0), "SNAPSHOT of the caller wrong");
+	record = snapOf(memberPid);
+	check((record != NULL) && (record->ps_state == PSBLOCKED) && (record->ps_semAdd == &gate)
+		&& (record->ps_device == NODEVICE), "SNAPSHOT of a blocked child wrong");
+	check((record->ps_ppid == rootPid) && (record->ps_grpID == TESTGROUP), "SNAPSHOT parent or group wrong");
+	record = snapOf(clockPid);
+	check((record != NULL) && (record->ps_state == PSBLOCKED) && (record->ps_device == CLOCKINDEX), "SNAPSHOT of a clock waiter wrong");
+	check(SYSCALL(SNAPSHOT, ADDR(&snap[0]), 1, 0) == 1, "SNAPSHOT overran its buffer");
+
+	SYSCALL(TERMINATEGROUP, TESTGROUP, 0, 0);
+	printf("snapshot ok\n");
+}
+
+/* SYS 25: the trace ring, drained, then a creation read back out of it */
+void testTrace() {
+	int	count;
+#ifdef KTRACE
+	int	i;
+#endif
+
+	while (SYSCALL(READTRACE, ADDR(&events[0]), TRACESIZE, 0) == TRACESIZE)
+		;
+	spawn(gateMember, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	count = SYSCALL(READTRACE, ADDR(&events[0]), TRACESIZE, 0);
+#ifdef KTRACE
+	for (i = 0; (i < count) && ((events[i].t_type != TR_CREATE) || (events[i].t_pid != memberPid)); i++)
+		;
+	check(i < count, "READTRACE missed a creation");
+	check(events[i].t_arg == (unsigned int) rootPid, "READTRACE creation has the wrong parent");
+#else
+	check(count == 0, "READTRACE without KTRACE returned events");
+#endif
+
+	SYSCALL(TERMINATEGROUP, TESTGROUP, 0, 0);
+	printf("trace ok\n");
+}
+
+/* SYS 30: a semaphore one child blocked on, in the statistics */
+void testSemTop() {
+	int	count;
+#ifdef SEMSTATS
+	int	i;
+#endif
+
+	spawn(contender, 0);
+	yieldSome();
+	SYSCALL(VERHOGEN, ADDR(&contended), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&done), 0, 0);
+	count = SYSCALL(SEMTOP, ADDR(&stats[0]), SEMSTATSIZE, 0);
+#ifdef SEMSTATS
+	for (i = 0; (i < count) && (stats[i].ss_semAdd != &contended); i++)
+		;
+	check(i < count, "SEMTOP missed a contended semaphore");
+	check((stats[i].ss_P == 1) && (stats[i].ss_contended == 1), "SEMTOP counted the wrong Ps");
+	check(stats[i].ss_waitTotal > 0, "SEMTOP missed the wait");
+#else
+	check(count == 0, "SEMTOP without SEMSTATS returned entries");
+#endif
+	printf("semtop ok\n");
+}
+
+/* SYS 31: one line on terminal 0, counted a character at a time */
+void testDevStats() {
+	devstat_t *term = &devices[TERM0WRITEINDEX];
+
+	SYSCALL(DEVSTATS, ADDR(&devices[0]), TRUE, 0);
+	print(DEVLINE);
+	SYSCALL(DEVSTATS, ADDR(&devices[0]), FALSE, 0);
+	check(term->d_ops == strlen(DEVLINE), "DEVSTATS counted the wrong operations");
+	check((term->d_errors == 0) && (term->d_outstanding == 0), "DEVSTATS counted errors or waiters");
+	check(term->d_busyTime > 0, "DEVSTATS missed the busy time");
+	printf("devstats ok\n");
+}
+
+/* SYS 33: one child computing while the root waits on the clock */
+void testLoadAvg() {
+	int	before, i;
+
+	spawn(loadSpinner, 0);
+	SYSCALL(PASSEREN, ADDR(&ready), 0, 0);
+	SYSCALL(LOADAVG, ADDR(&load), 0, 0);
+	before = load.la_ticks;
+	for (i = 0; i < LOADTICKS; i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	SYSCALL(LOADAVG, ADDR(&load), 0, 0);
+	check(load.la_ticks == before + LOADTICKS, "LOADAVG sampled the wrong intervals");
+	check(load.la_runnable + load.la_softBlocked == 2, "LOADAVG counted the wrong processes");
+	check(load.la_idle == 0, "LOADAVG saw idle time");
+	check(load.la_load[0] > LOADONE, "LOADAVG average too low");
+
+	SYSCALL(TERMINATEGROUP, TESTGROUP, 0, 0);
+	printf("loadavg ok\n");
+}
+
+/* SYS 34: the kernel log so far, then nothing new */
+void testKlog() {
+	char	line[LINELEN];
+	int		count, dropped = -1;
+
+	count = SYSCALL(KLOGREAD, ADDR(&logText[0]), KLOGSIZE, ADDR(&dropped));
+	check((count > 0) && (dropped == 0), "KLOGREAD lost the log");
+	logText[count] = '\0';
+	check(strstr(logText, "<2>JaeOS nucleus started\n") != NULL, "KLOGREAD missed the boot line");
+	sprintf(line, "<1>over CPU budget, killing pid %x\n", killedPid);
+	check(strstr(logText, line) != NULL, "KLOGREAD missed the budget kill");
+	check(SYSCALL(KLOGREAD, ADDR(&logText[0]), KLOGSIZE, ADDR(&dropped)) == 0, "KLOGREAD read a line twice");
+	printf("klog ok\n");
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	printf("hosttest starts\n");
+
+	rootPid = SYSCALL(GETPID, 0, 0, 0);
+	STST(&childState);
+	rootSp = childState.sp;
+	childState.cpsr = ALLOFF | SYSMODE;
+
+	testGroups();
+	testBudgets();
+	testAdmission();
+	testTimes();
+	testSnapshot();
+	testTrace();
+	testSemTop();
+	testDevStats();
+	testLoadAvg();
+	testKlog();
+
+	/* the mock only moves devices on while someone waits or computes,
+	   so let the kernel log drain before klogFlush() polls for it */
+	SYSCALL(WAITCLOCK, 0, 0, 0);
+	printf("hosttest finished\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* joins the test group, then counts and yields forever */
+void spinMember() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	for (;;) {
+		spins++;
+		SYSCALL(YIELD, 0, 0, 0);
+	}
+}
+
+/* suspends its own group, itself included */
+void selfSuspender() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	SYSCALL(SUSPENDGROUP, TESTGROUP, 0, 0);
+	woke = 1;
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* blocks on the gate */
+void gateMember() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&gate), 0, 0);
+	woke = 1;
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* waits on the pseudo-clock over and over */
+void clockMember() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	clockPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	for (;;)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+}
+
+/* blocks on a semaphore of its own until the root lets it go */
+void contender() {
+	SYSCALL(PASSEREN, ADDR(&contended), 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* collects its signals twice once through the gate */
+void signalMember() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&gate), 0, 0);
+	sigs[0] = SYSCALL(GETSIGNALS, 0, 0, 0);
+	sigs[1] = SYSCALL(GETSIGNALS, 0, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* terminates its own group, child and all */
+void groupKiller() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	spawn(parkChild, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	SYSCALL(TERMINATEGROUP, TESTGROUP, 0, 0);
+	after = 1;
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* waits to be terminated */
+void parkChild() {
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* tries to budget the root, which is not its to budget */
+void budgetProbe() {
+	SYSCALL(SETGROUP, BUDGETGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	probeResult = SYSCALL(SETBUDGET, rootPid, BUDGETUS, 0);
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* computes SPINTICKS on a budget a few times smaller */
+void budgetSpinner() {
+	SYSCALL(SETGROUP, BUDGETGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(SETBUDGET, 0, BUDGETUS, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	uarmCompute(SPINTICKS);
+	SYSCALL(GETBUDGET, 0, ADDR(&budget), 0);
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* holds a BUDGETKILL budget its child spends */
+void budgetKiller() {
+	SYSCALL(SETGROUP, BUDGETGROUP, 0, 0);
+	memberPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(SETBUDGET, 0, BUDGETUS, BUDGETSUBTREE | BUDGETKILL);
+	spawn(computeChild, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* holds a ProcBlk until told to quit */
+void filler() {
+	SYSCALL(SETGROUP, FILLGROUP, 0, 0);
+	SYSCALL(PASSEREN, ADDR(&quit), 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* creator n: waits in SYS 1 for a ProcBlk for createdKid(n) */
+void creator(int n) {
+	SYSCALL(SETGROUP, CREATEGROUP, 0, 0);
+	prepare(&kidState[n], createdKid, n);
+	arrival[arrivals++] = n;
+	created[n] = SYSCALL(CREATEPROCESS, ADDR(&kidState[n]), TRUE, 0);
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&park), 0, 0);
+}
+
+/* creator n's child: says when it started, then gives its ProcBlk back */
+void createdKid(int n) {
+	admitted[admissions++] = n;
+	SYSCALL(VERHOGEN, ADDR(&done), 0, 0);
+	SYSCALL(PASSEREN, ADDR(&quit), 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* computes CHILDTICKS once the timed children below it, n levels deep, are done */
+void timedChild(int n) {
+	if (n > 0) {
+		spawn(timedChild, n - 1);
+		SYSCALL(PASSEREN, ADDR(&timedDone[n - 1]), 0, 0);
+	}
+	uarmCompute(CHILDTICKS);
+	SYSCALL(VERHOGEN, ADDR(&timedDone[n]), 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* computes until it is killed */
+/* computes for good, in a group so it can be got rid of */
+void loadSpinner() {
+	SYSCALL(SETGROUP, TESTGROUP, 0, 0);
+	SYSCALL(VERHOGEN, ADDR(&ready), 0, 0);
+	for (;;)
+		uarmCompute(QUANTUM);
+}
+
+void computeChild() {
+	for (;;)
+		uarmCompute(QUANTUM);
+}
+
+
+int main() {
+	return (uarmRun(kernelMain));
+}
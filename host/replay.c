@@ -0,0 +1,239 @@
+/*********************************REPLAY.C*******************************
+ *
+ *	Replays the phase 1 calls a -DKRECORD nucleus recorded (see
+ *	phase2/record.c) against whichever ProcBlk and ASL modules it
+ *	is linked with, and times them:
+ *		replay.host		phase1/pcb.c and phase1/asl.c (sorted list)
+ *		replayhash.host	phase1/pcb.c and aslhash.c (hash table)
+ *
+ *	The trace is the terminal 0 log of the recording run, under
+ *	uARM (term0.uarm) or on the host (./kernel.host > run.rec);
+ *	everything before the REC line is skipped.
+ *		./replay.host run.rec [passes]
+ *
+ *	The first pass checks every result against the recording and
+ *	stops at the first difference. The rest are timed as a whole,
+ *	the best one counting, and then once more call by call for
+ *	the per operation table.
+ *
+ *	Semaphores are replayed at addresses in the same order as the
+ *	recorded ones, since a sorted ASL depends on that order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "uarm/libuarm.h"
+#include "../e/pcb.e"
+#include "../e/asl.e"
+
+
+#define PASSES			200
+#define LINELENGTH		128
+#define PCBOF(name)		(((name) == RC_NONE) ? NULL : pcbs[name])
+
+unsigned int	*calls;
+unsigned int	callCount;
+unsigned int	semCount, queueCount;
+
+int		semTable[RECSEMS];				/* the replayed semaphores */
+int		*sems[RECSEMS];					/* semaphore of each recorded name */
+unsigned int semAddrs[RECSEMS];			/* recorded address of each name */
+pcb_PTR	queues[RECQUEUES];				/* tail pointer of each recorded queue */
+pcb_PTR	pcbs[MAXPROC];					/* ProcBlk of each recorded slot */
+
+char	*opNames[RC_OPS] = {"", "allocPcb", "freePcb", "insertProcQ", "removeProcQ",
+			"outProcQ", "headProcQ", "insertChild", "removeChild", "outChild",
+			"insertBlocked", "removeBlocked", "outBlocked", "headBlocked"};
+
+
+/* read the REC ... END block of a terminal log, FALSE if there is none */
+int load(char *path) {
+	FILE			*trace = fopen(path, "r");
+	char			line[LINELENGTH];
+	unsigned int	count, lost, name, word;
+	int				inside = FALSE;
+
+	if (trace == NULL)
+		return (FALSE);
+	while (fgets(line, sizeof(line), trace) != NULL) {
+		if (sscanf(line, "REC %x %x %x %x", &count, &lost, &semCount, &queueCount) == 4) {
+			inside = TRUE;
+			callCount = 0;
+			calls = realloc(calls, (count + 1) * sizeof(unsigned int));
+			if (lost != 0)
+				fprintf(stderr, "replay: recording filled up, %u later calls are not in it\n", lost);
+		}
+		else if (!inside)
+			continue;
+		else if (sscanf(line, "S %x %x", &name, &word) == 2) {
+			if (name < RECSEMS)
+				semAddrs[name] = word;
+		}
+		else if ((sscanf(line, "C %x", &word) == 1) && (callCount < count))
+			calls[callCount++] = word;
+		else if (strncmp(line, "END", 3) == 0)
+			break;
+	}
+	fclose(trace);
+	return (inside && (semCount <= RECSEMS) && (queueCount <= RECQUEUES));
+}
+
+/* give each semaphore name an address, in the recorded order */
+void placeSems() {
+	int i, j, rank;
+
+	for (i = 0; i < semCount; i++) {
+		rank = 0;
+		for (j = 0; j < semCount; j++)
+			if ((semAddrs[j] < semAddrs[i]) || ((semAddrs[j] == semAddrs[i]) && (j < i)))
+				rank++;
+		sems[i] = &semTable[rank];
+	}
+}
+
+/* the state the nucleus started recording in */
+void reset() {
+	int i;
+
+	initPcbs();
+	initASL();
+	for (i = 0; i < RECQUEUES; i++)
+		queues[i] = mkEmptyProcQ();
+	for (i = 0; i < MAXPROC; i++)
+		pcbs[i] = NULL;
+}
+
+/* make one recorded call, TRUE if it returned what it did then */
+int replayCall(unsigned int call) {
+	int		op = call >> 24;
+	int		a = (call >> 16) & 0xFF, b = (call >> 8) & 0xFF, r = call & 0xFF;
+	pcb_PTR	p;
+
+	switch (op) {
+	case RC_ALLOCPCB:
+		p = allocPcb();
+		if (r != RC_NONE)
+			pcbs[r] = p;
+		return ((p == NULL) == (r == RC_NONE));
+	case RC_FREEPCB:
+		freePcb(PCBOF(a));
+		return (TRUE);
+	case RC_INSERTPROCQ:
+		insertProcQ(&queues[a], PCBOF(b));
+		return (TRUE);
+	case RC_REMOVEPROCQ:
+		return (removeProcQ(&queues[a]) == PCBOF(r));
+	case RC_OUTPROCQ:
+		return (outProcQ(&queues[a], PCBOF(b)) == PCBOF(r));
+	case RC_HEADPROCQ:
+		return (headProcQ(PCBOF(a)) == PCBOF(r));
+	case RC_INSERTCHILD:
+		insertChild(PCBOF(a), PCBOF(b));
+		return (TRUE);
+	case RC_REMOVECHILD:
+		return (removeChild(PCBOF(a)) == PCBOF(r));
+	case RC_OUTCHILD:
+		return (outChild(PCBOF(a)) == PCBOF(r));
+	case RC_INSERTBLOCKED:
+		return (insertBlocked(sems[a], PCBOF(b)) == r);
+	case RC_REMOVEBLOCKED:
+		return (removeBlocked(sems[a]) == PCBOF(r));
+	case RC_OUTBLOCKED:
+		return (outBlocked(PCBOF(a)) == PCBOF(r));
+	case RC_HEADBLOCKED:
+		return (headBlocked(sems[a]) == PCBOF(r));
+	}
+	return (FALSE);
+}
+
+/* FALSE if a call names something the recorder had no name for */
+int checkNames() {
+	unsigned int	i;
+	int				op, a;
+
+	for (i = 0; i < callCount; i++) {
+		op = calls[i] >> 24;
+		a = (calls[i] >> 16) & 0xFF;
+		if ((op <= 0) || (op >= RC_OPS))
+			return (FALSE);
+		if (((op == RC_INSERTPROCQ) || (op == RC_REMOVEPROCQ) || (op == RC_OUTPROCQ)) && (a >= queueCount))
+			return (FALSE);
+		if (((op == RC_INSERTBLOCKED) || (op == RC_REMOVEBLOCKED) || (op == RC_HEADBLOCKED)) && (a >= semCount))
+			return (FALSE);
+	}
+	return (TRUE);
+}
+
+
+int main(int argc, char *argv[]) {
+	int					passes = PASSES, pass, op;
+	unsigned int		i;
+	unsigned long long	start, best = ~0ULL, overhead, spent;
+	unsigned long long	opCycles[RC_OPS];
+	unsigned int		opCalls[RC_OPS];
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s trace [passes]\n", argv[0]);
+		return (2);
+	}
+	if (argc > 2)
+		passes = atoi(argv[2]);
+	if (!load(argv[1]) || !checkNames()) {
+		fprintf(stderr, "replay: no usable REC ... END trace in %s\n", argv[1]);
+		return (1);
+	}
+	placeSems();
+	printf("%s: %u calls, %d semaphores, %d queues\n", argv[1], callCount, semCount, queueCount);
+
+	reset();
+	for (i = 0; i < callCount; i++) {
+		if (!replayCall(calls[i])) {
+			printf("call %u (%s, word %08x) returned something else than when recorded\n",
+				i, opNames[calls[i] >> 24], calls[i]);
+			return (1);
+		}
+	}
+	printf("every result matches the recording\n");
+
+	for (pass = 0; pass < passes; pass++) {
+		reset();
+		start = uarmCycles();
+		for (i = 0; i < callCount; i++)
+			replayCall(calls[i]);
+		spent = uarmCycles() - start;
+		if (spent < best)
+			best = spent;
+	}
+	printf("best of %d passes: %.1f cycles/call, %.1f ns/call\n", passes,
+		(double) best / callCount, (best * 1000.0) / ((double) uarmCyclesPerUs() * callCount));
+
+	/* once more, call by call, less what reading the counter costs */
+	overhead = ~0ULL;
+	for (pass = 0; pass < PASSES; pass++) {
+		start = uarmCycles();
+		spent = uarmCycles() - start;
+		if (spent < overhead)
+			overhead = spent;
+	}
+	memset(opCycles, 0, sizeof(opCycles));
+	memset(opCalls, 0, sizeof(opCalls));
+	reset();
+	for (i = 0; i < callCount; i++) {
+		op = calls[i] >> 24;
+		start = uarmCycles();
+		replayCall(calls[i]);
+		spent = uarmCycles() - start;
+		opCycles[op] += (spent > overhead) ? (spent - overhead) : 0;
+		opCalls[op]++;
+	}
+	printf("%-16s %8s %12s\n", "operation", "calls", "cycles/call");
+	for (op = 1; op < RC_OPS; op++)
+		if (opCalls[op] != 0)
+			printf("%-16s %8u %12.1f\n", opNames[op], opCalls[op], (double) opCycles[op] / opCalls[op]);
+	return (0);
+}
@@ -0,0 +1,47 @@
+#ifndef UARM_ARCH_H
+#define UARM_ARCH_H
+
+/************************* ARCH.H *****************************
+*
+*  Mock of uARM's arch.h for the host build (see libuarm.c):
+*  the same machine constants, but every physical address goes
+*  through PHYSADDR() so it lands in the simulated bus, uarmBus[],
+*  instead of near the host's address 0.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+extern unsigned char uarmBus[];
+
+#define PHYSADDR(address)		((unsigned long) uarmBus + (address))
+
+#define WORD_SIZE				4
+
+#define DEV_USED_INTS			5
+#define DEV_PER_INT				8
+#define DEV_REG_SIZE_W			4
+#define DEV_REG_SIZE			(DEV_REG_SIZE_W * WORD_SIZE)
+#define DEV_REG_START			0x40
+#define DEV_IL_START			3
+#define DEV_REG_ADDR(line, dev)	PHYSADDR(DEV_REG_START + ((line) - DEV_IL_START) * DEV_PER_INT * DEV_REG_SIZE + (dev) * DEV_REG_SIZE)
+
+#define IL_IPI					0
+#define IL_CPUTIMER				1
+#define IL_TIMER				2
+#define IL_DISK					3
+#define IL_TAPE					4
+#define IL_ETHERNET				5
+#define IL_PRINTER				6
+#define IL_TERMINAL				7
+
+#define BUS_REG_RAM_BASE		PHYSADDR(0x2D0)
+#define BUS_REG_RAM_SIZE		PHYSADDR(0x2D4)
+#define BUS_REG_TIME_SCALE		PHYSADDR(0x2E8)
+
+// RAM itself is not simulated: stack pointers only name a process' stack
+#define RAM_BASE				0x8000
+#define HOSTRAMSIZE				0x100000
+#define RAM_TOP					(RAM_BASE + HOSTRAMSIZE)
+#define FRAME_SIZE				4096
+
+#endif
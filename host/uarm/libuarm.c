@@ -0,0 +1,752 @@
+/**************************************************************
+* FILENAME:		libuarm.c
+*
+* DESCRIPTION:	Mock uARM Library for the JaeOS host build
+*
+* NOTES:		Lets the nucleus run natively on the development machine
+*				(make host), so it can be benchmarked and profiled with
+*				ordinary tools instead of under the uARM GUI.
+*
+*				The low RAM_BASE bytes of the machine, where the device
+*				registers, interrupt bitmaps and exception areas live,
+*				are uarmBus[]; arch.h's PHYSADDR() points the nucleus'
+*				addresses into it. The clock is simulated: it only moves
+*				when process code calls uarmCompute(), when WAIT skips
+*				to the next event, and by one tick on every TOD read so
+*				no interval in the nucleus is ever empty.
+*
+*				Every process runs as a host coroutine (ucontext) on its
+*				own stack, named by the sp in its state_t. SYSCALL, and
+*				interrupts that fall due during uarmCompute(), save the
+*				process' registers in the right old area, with a unique
+*				token as its pc, and start the handler from the new area
+*				on a fresh kernel stack. LDST resumes the coroutine whose
+*				sp and token match, or starts a new one at pc if they do
+*				not (a new process, or a SYS 5 handler).
+*
+*				Devices complete every command after a fixed delay, or
+*				after whatever the harness' uarmServiceTime() function
+*				says. A character sent to terminal n is written to
+*				termn.host, and terminal 0 is also echoed on stdout,
+*				unless uarmQuiet() turned output off. Nothing is ever
+*				typed, and disks do not keep their data.
+*
+*				Nucleus code takes no simulated time beyond the tick per
+*				TOD read, unless uarmKernelCost() charges every entry.
+*
+*				Pointers travel through 32 bit registers exactly as on
+*				uARM, so the host build is linked -no-pie and process
+*				stacks are static: everything stays below 4GB.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <time.h>
+
+#include "../../h/const.h"
+#include "../../h/types.h"
+
+#include "uarm/libuarm.h"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+#define HOSTCONTEXTS		64 			// distinct process stacks at once
+#define HOSTSTACK			65536 		// bytes of host stack per coroutine
+#define HOSTPCBASE			0xF0000000 	// top nibble of the tokens stored as a trapped process' pc
+#define TERMTICKS			1000 		// ticks to send a character
+#define DEVTICKS			5000 		// ticks for any other device operation
+#define NOEVENT				0xFFFFFFFFFFFFFFFFULL
+#define INTSMASK			0x000000C0 	// cpsr bits that disable interrupts
+#define PRINTCHR			2
+#define RECEIVECHR			2
+#define DEVBUSY				3
+#define TERMSUBDEVS			2 			// receiver, transmitter
+
+typedef struct hostctx_t {
+	ucontext_t		h_context;
+	BOOL			h_used;
+	unsigned int	h_sp;			// the sp its state_t carries
+	unsigned int	h_token;		// pc it was saved with, 0 if never trapped
+	void			(*h_entry)();	// where it started
+	char			h_stack[HOSTSTACK];
+} hostctx_t;
+
+unsigned char uarmBus[RAM_BASE] __attribute__((aligned(16)));
+
+HIDDEN hostctx_t contexts[HOSTCONTEXTS];
+HIDDEN hostctx_t *running;			// coroutine on the CPU, NULL in the nucleus
+HIDDEN state_t cpu;					// registers of whoever is on the CPU
+HIDDEN unsigned int tokenSerial;
+
+HIDDEN ucontext_t hostContext;		// uarmRun()'s caller
+HIDDEN ucontext_t kernelContext[2];	// the nucleus, alternating stacks
+HIDDEN char kernelStack[2][HOSTSTACK];
+HIDDEN int kernelSide;
+HIDDEN void (*kernelEntry)();		// handler (or boot) the fresh kernel stack runs
+HIDDEN int exitCode;
+HIDDEN BOOL powered;				// inside uarmRun()
+HIDDEN unsigned int cyclesPerUs;	// uarmCyclesPerUs(), once measured
+
+HIDDEN unsigned long long simClock;
+HIDDEN unsigned long long timerDue;
+
+HIDDEN unsigned long long deviceDue[DEV_USED_INTS * DEV_PER_INT][TERMSUBDEVS]; // NOEVENT if idle
+HIDDEN unsigned int deviceResult[DEV_USED_INTS * DEV_PER_INT][TERMSUBDEVS];
+HIDDEN BOOL devicePending[DEV_USED_INTS * DEV_PER_INT][TERMSUBDEVS]; // done, not acknowledged
+HIDDEN FILE *termFile[DEV_PER_INT];
+HIDDEN BOOL quiet;					// no terminal files or echo, no HALT line
+HIDDEN unsigned int kernelCost;		// ticks charged per kernel entry
+HIDDEN unsigned int (*serviceTime)(int line, int device); // NULL for the fixed delays
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   ROM services, as declared in libuarm.h
+//	   int uarmRun(void (*boot)());
+//	   void uarmCompute(unsigned int ticks);
+//	   unsigned long long uarmClock();
+//	   void uarmServiceTime(unsigned int (*ticks)(int line, int device));
+//	   void uarmKernelCost(unsigned int ticks);
+//	   void uarmQuiet(BOOL on);
+//	   unsigned long long uarmCycles();
+//	   unsigned int uarmCyclesPerUs();
+/********************* Private Functions *********************/
+HIDDEN void enterKernel (unsigned long oldArea, unsigned long newArea, state_t *saved);
+HIDDEN void kernelStart ();
+HIDDEN void processStart ();
+HIDDEN hostctx_t *findContext (unsigned int sp);
+HIDDEN unsigned int nextToken ();
+HIDDEN unsigned int pendingLines ();
+HIDDEN unsigned long long nextEvent ();
+HIDDEN void deviceCommands ();
+HIDDEN void deviceCompletions ();
+HIDDEN void startOperation (int device, int sub, unsigned long long ticks, unsigned int result);
+HIDDEN unsigned long long operationTicks (int device, unsigned long long ticks);
+HIDDEN void setPending (int device, int sub, BOOL on);
+HIDDEN void termOutput (int terminal, char c);
+HIDDEN unsigned long long hostNs ();
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- uarmRun() ---------------------------------------
+* Parameters: 	void (*boot)() (the nucleus' main)
+* Type: 		Public
+* Return:		0 after HALT, 1 after PANIC
+* Description:
+*	Power on: every device ready, the clock at 0, and boot
+*	running on a kernel stack with interrupts off.
+* --------------------------------- end uarmRun() ---- */
+int uarmRun(void (*boot)()){
+	int d, s;
+
+	for(d = 0; d < DEV_USED_INTS * DEV_PER_INT; d++){
+		devreg_t *device = (devreg_t *) (PHYSADDR(DEV_REG_START) + (d * DEV_REG_SIZE));
+		device->dtp.status = DEV_S_READY;
+		device->term.transm_status = DEV_S_READY;
+		for(s = 0; s < TERMSUBDEVS; s++){
+			deviceDue[d][s] = NOEVENT;
+		}
+	}
+	*((unsigned int *) BUS_REG_TIME_SCALE) = 1; // a tick per "microsecond"
+	*((unsigned int *) BUS_REG_RAM_BASE) = RAM_BASE;
+	*((unsigned int *) BUS_REG_RAM_SIZE) = HOSTRAMSIZE;
+
+	cpu.cpsr = SYSMODE | INTSMASK;
+	powered = TRUE;
+	timerDue = NOEVENT;
+	kernelEntry = boot;
+	kernelSide = 0;
+	getcontext(&kernelContext[0]);
+	kernelContext[0].uc_stack.ss_sp = kernelStack[0];
+	kernelContext[0].uc_stack.ss_size = HOSTSTACK;
+	kernelContext[0].uc_link = NULL;
+	makecontext(&kernelContext[0], kernelStart, 0);
+	swapcontext(&hostContext, &kernelContext[0]); // back here on HALT or PANIC
+	powered = FALSE;
+
+	for(d = 0; d < DEV_PER_INT; d++){
+		if(termFile[d] != NULL){
+			fclose(termFile[d]);
+			termFile[d] = NULL;
+		}
+	}
+	return (exitCode);
+}
+
+/* ---- uarmCompute() ---------------------------------------
+* Parameters: 	unsigned int ticks
+* Type: 		Public
+* Return:		None
+* Description:
+*	The running process computes for ticks. Any interrupt that
+*	falls due meanwhile is taken at that point, and the rest of
+*	the time is spent once the process is resumed.
+* --------------------------------- end uarmCompute() ---- */
+void uarmCompute(unsigned int ticks){
+	unsigned long long remaining = ticks;
+	unsigned long long due;
+	state_t saved;
+
+	deviceCommands();
+	while(TRUE){
+		due = nextEvent();
+		if(((cpu.cpsr & INTSMASK) != 0) || (due > simClock + remaining)){
+			simClock = simClock + remaining;
+			break;
+		}
+		if(due > simClock){
+			remaining = remaining - (due - simClock); // the rest is spent once resumed
+			simClock = due;
+		}
+		deviceCompletions();
+
+		saved = cpu;
+		running->h_token = nextToken();
+		saved.pc = running->h_token + PCPREFETCH; // as if fetched ahead
+		saved.CP15_Cause = pendingLines() << LINENUMOFFSET;
+		enterKernel(INTOLDADD, INTNEWADD, &saved);
+	}
+	deviceCompletions();
+}
+
+/* ---- uarmClock() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		The simulated clock, in ticks
+* --------------------------------- end uarmClock() ---- */
+unsigned long long uarmClock(){
+	return (simClock);
+}
+
+/* ---- uarmServiceTime() ---------------------------------------
+* Parameters: 	unsigned int (*ticks)(int line, int device)
+* Type: 		Public
+* Return:		None
+* Description:
+*	From now on every device operation takes ticks(line, device)
+*	to complete, instead of TERMTICKS or DEVTICKS. NULL goes back
+*	to the fixed delays.
+* --------------------------------- end uarmServiceTime() ---- */
+void uarmServiceTime(unsigned int (*ticks)(int line, int device)){
+	serviceTime = ticks;
+}
+
+/* ---- uarmKernelCost() ---------------------------------------
+* Parameters: 	unsigned int ticks
+* Type: 		Public
+* Return:		None
+* Description:
+*	Charge ticks of simulated time for every exception or
+*	interrupt taken, so kernel entries are not free.
+* --------------------------------- end uarmKernelCost() ---- */
+void uarmKernelCost(unsigned int ticks){
+	kernelCost = ticks;
+}
+
+/* ---- uarmQuiet() ---------------------------------------
+* Parameters: 	BOOL on
+* Type: 		Public
+* Return:		None
+* Description:
+*	Throw terminal output away and skip the HALT message, for
+*	harnesses running many machines side by side.
+* --------------------------------- end uarmQuiet() ---- */
+void uarmQuiet(BOOL on){
+	quiet = on;
+}
+
+/* ---- uarmCycles() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		The host's cycle counter (ns where there is none)
+* Description:
+*	Real time, for code timing itself on the host the way it
+*	would with getTODLO() on uARM, where the TOD counts cycles.
+* --------------------------------- end uarmCycles() ---- */
+unsigned long long uarmCycles(){
+#if defined(__x86_64__) || defined(__i386__)
+	return (__builtin_ia32_rdtsc());
+#else
+	return (hostNs());
+#endif
+}
+
+/* ---- uarmCyclesPerUs() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		uarmCycles() per microsecond
+* Description:
+*	Measured against the host clock over 10ms, the first time.
+* --------------------------------- end uarmCyclesPerUs() ---- */
+unsigned int uarmCyclesPerUs(){
+	unsigned long long startNs, startCycles;
+
+	if(cyclesPerUs == 0){
+		startNs = hostNs();
+		startCycles = uarmCycles();
+		while(hostNs() - startNs < 10000000ULL);
+		cyclesPerUs = (unsigned int) (((uarmCycles() - startCycles) * 1000) / (hostNs() - startNs));
+		if(cyclesPerUs == 0){
+			cyclesPerUs = 1;
+		}
+	}
+	return (cyclesPerUs);
+}
+
+/* ---- SYSCALL() ---------------------------------------
+* Parameters: 	number and three arguments, into a1-a4
+* Type: 		Public
+* Return:		a1 when the process is resumed
+* Description:
+*	Trap into the nucleus through the SYS/BP areas.
+* --------------------------------- end SYSCALL() ---- */
+unsigned int SYSCALL(unsigned int number, unsigned int arg1, unsigned int arg2, unsigned int arg3){
+	state_t saved = cpu;
+
+	if(running == NULL){
+		fprintf(stderr, "host: SYSCALL from the nucleus\n");
+		PANIC();
+	}
+
+	saved.a1 = number;
+	saved.a2 = arg1;
+	saved.a3 = arg2;
+	saved.a4 = arg3;
+	running->h_token = nextToken();
+	saved.pc = running->h_token;
+	enterKernel(SYSOLDADD, SYSNEWADD, &saved);
+	return (cpu.a1); // LDST put our registers back
+}
+
+/* ---- LDST() ---------------------------------------
+* Parameters: 	void *state
+* Type: 		Public
+* Return:		Never
+* Description:
+*	Load a processor state: take a pending interrupt if it
+*	enables them, otherwise run (or resume) its coroutine.
+* --------------------------------- end LDST() ---- */
+void LDST(void *state){
+	state_t saved = *((state_t *) state);
+	hostctx_t *target;
+
+	deviceCommands();
+	deviceCompletions();
+	cpu = saved;
+
+	if(((saved.cpsr & INTSMASK) == 0) && (pendingLines() != 0)){
+		saved.pc = saved.pc + PCPREFETCH;
+		saved.CP15_Cause = pendingLines() << LINENUMOFFSET;
+		running = NULL;
+		enterKernel(INTOLDADD, INTNEWADD, &saved);
+	}
+
+	target = findContext(saved.sp);
+	if((target->h_token == 0) || (target->h_token != saved.pc)){
+		// never ran, or a different process/handler on the same stack
+		target->h_token = 0;
+		target->h_entry = (void (*)()) (unsigned long) saved.pc;
+		getcontext(&(target->h_context));
+		target->h_context.uc_stack.ss_sp = target->h_stack;
+		target->h_context.uc_stack.ss_size = HOSTSTACK;
+		target->h_context.uc_link = NULL;
+		makecontext(&(target->h_context), processStart, 0);
+	}
+
+	running = target;
+	setcontext(&(target->h_context));
+}
+
+/* ---- STST() ---------------------------------------
+* Parameters: 	void *state
+* Type: 		Public
+* Return:		None
+* Description:
+*	Store the current processor state.
+* --------------------------------- end STST() ---- */
+void STST(void *state){
+	*((state_t *) state) = cpu;
+}
+
+/* ---- WAIT() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		Never (the interrupt handler takes over)
+* Description:
+*	Skip the clock to the next timer or device event and take
+*	its interrupt.
+* --------------------------------- end WAIT() ---- */
+void WAIT(){
+	unsigned long long due;
+	state_t saved = cpu;
+
+	deviceCommands();
+	due = nextEvent();
+	if(due == NOEVENT){
+		fprintf(stderr, "host: WAIT with nothing to wait for\n");
+		PANIC();
+	}
+	if(due > simClock){
+		simClock = due;
+	}
+	deviceCompletions();
+
+	saved.pc = PCPREFETCH;
+	saved.CP15_Cause = pendingLines() << LINENUMOFFSET;
+	enterKernel(INTOLDADD, INTNEWADD, &saved);
+}
+
+/* ---- HALT() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		Never (uarmRun() returns 0, or the program exits
+*				if it never called uarmRun())
+* --------------------------------- end HALT() ---- */
+void HALT(){
+	if(!quiet){
+		printf("host: HALT at tick %llu\n", simClock);
+	}
+	exitCode = 0;
+	if(!powered){
+		exit(exitCode);
+	}
+	setcontext(&hostContext);
+}
+
+/* ---- PANIC() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		Never (uarmRun() returns 1, or the program exits)
+* --------------------------------- end PANIC() ---- */
+void PANIC(){
+	fprintf(stderr, "host: PANIC at tick %llu\n", simClock);
+	exitCode = 1;
+	if(!powered){
+		exit(exitCode);
+	}
+	setcontext(&hostContext);
+}
+
+unsigned int getTODHI(){
+	return ((unsigned int) (simClock >> 32));
+}
+
+unsigned int getTODLO(){
+	simClock++;
+	return ((unsigned int) simClock);
+}
+
+unsigned int getTIMER(){
+	return ((unsigned int) (timerDue - simClock));
+}
+
+unsigned int setTIMER(unsigned int timer){
+	timerDue = simClock;
+	if((int) timer > 0){
+		timerDue = simClock + timer;
+	}
+	return (timer);
+}
+
+unsigned int getSTATUS(){
+	return (cpu.cpsr);
+}
+
+unsigned int setSTATUS(unsigned int status){
+	cpu.cpsr = status;
+	return (status);
+}
+
+unsigned int getCAUSE(){
+	return (pendingLines() << LINENUMOFFSET);
+}
+
+unsigned int getCONTROL(){
+	return (cpu.CP15_Control);
+}
+
+unsigned int setCONTROL(unsigned int control){
+	cpu.CP15_Control = control;
+	return (control);
+}
+
+void tprint(char *s){
+	fputs(s, stdout);
+}
+
+/* ---- enterKernel() ---------------------------------------
+* Parameters: 	old and new area addresses, the state to save
+* Type: 		Private
+* Return:		When the saved process is resumed (if ever)
+* Description:
+*	Save the state in the old area and start the handler in
+*	the new area on the kernel stack not in use.
+* --------------------------------- end enterKernel() ---- */
+HIDDEN void enterKernel(unsigned long oldArea, unsigned long newArea, state_t *saved){
+	hostctx_t *from = running;
+	ucontext_t *kernel;
+
+	*((state_t *) oldArea) = *saved;
+	cpu = *((state_t *) newArea);
+	simClock = simClock + kernelCost;
+	kernelEntry = (void (*)()) (unsigned long) cpu.pc;
+
+	kernelSide = 1 - kernelSide;
+	kernel = &kernelContext[kernelSide];
+	getcontext(kernel);
+	kernel->uc_stack.ss_sp = kernelStack[kernelSide];
+	kernel->uc_stack.ss_size = HOSTSTACK;
+	kernel->uc_link = NULL;
+	makecontext(kernel, kernelStart, 0);
+
+	running = NULL;
+	if(from != NULL){
+		swapcontext(&(from->h_context), kernel);
+	}
+	else{
+		setcontext(kernel);
+	}
+}
+
+/* ---- kernelStart() ---------------------------------------
+* Description:	bottom of every kernel stack; handlers never return
+* --------------------------------- end kernelStart() ---- */
+HIDDEN void kernelStart(){
+	kernelEntry();
+	fprintf(stderr, "host: exception handler returned\n");
+	PANIC();
+}
+
+/* ---- processStart() ---------------------------------------
+* Description:
+*	Bottom of every process stack. As on uARM, the entry point
+*	gets a1 as its first argument.
+* --------------------------------- end processStart() ---- */
+HIDDEN void processStart(){
+	((void (*)(unsigned int)) running->h_entry)(cpu.a1);
+	fprintf(stderr, "host: process returned from its entry point\n");
+	PANIC();
+}
+
+/* ---- findContext() ---------------------------------------
+* Parameters: 	unsigned int sp
+* Type: 		Private
+* Return:		The coroutine for that stack, a new one if need be
+* --------------------------------- end findContext() ---- */
+HIDDEN hostctx_t *findContext(unsigned int sp){
+	hostctx_t *spare = NULL;
+	int i;
+
+	for(i = 0; i < HOSTCONTEXTS; i++){
+		if(contexts[i].h_used && (contexts[i].h_sp == sp)){
+			return (&contexts[i]);
+		}
+		if(!contexts[i].h_used && (spare == NULL)){
+			spare = &contexts[i];
+		}
+	}
+	if(spare == NULL){
+		fprintf(stderr, "host: more than %d process stacks\n", HOSTCONTEXTS);
+		PANIC();
+	}
+	spare->h_used = TRUE;
+	spare->h_sp = sp;
+	spare->h_token = 0;
+	return (spare);
+}
+
+/* ---- nextToken() ---------------------------------------
+* Return:		a pc for a trapping process that no code address matches
+* --------------------------------- end nextToken() ---- */
+HIDDEN unsigned int nextToken(){
+	tokenSerial++;
+	return (HOSTPCBASE | ((tokenSerial << 3) & ~HOSTPCBASE));
+}
+
+/* ---- pendingLines() ---------------------------------------
+* Return:		bit n set if interrupt line n is pending
+* --------------------------------- end pendingLines() ---- */
+HIDDEN unsigned int pendingLines(){
+	unsigned int lines = 0;
+	int line;
+
+	if(simClock >= timerDue){
+		lines = lines | LINETWO;
+	}
+	for(line = DEV_IL_START; line < DEV_IL_START + DEV_USED_INTS; line++){
+		if(*(((unsigned int *) DISKINTMAP) + (line - DEV_IL_START)) != 0){
+			lines = lines | (1 << line);
+		}
+	}
+	return (lines);
+}
+
+/* ---- nextEvent() ---------------------------------------
+* Return:		when the next interrupt will be pending (maybe now)
+* --------------------------------- end nextEvent() ---- */
+HIDDEN unsigned long long nextEvent(){
+	unsigned long long due = timerDue;
+	int d, s;
+
+	if(pendingLines() != 0){
+		return (simClock);
+	}
+	for(d = 0; d < DEV_USED_INTS * DEV_PER_INT; d++){
+		for(s = 0; s < TERMSUBDEVS; s++){
+			if(deviceDue[d][s] < due){
+				due = deviceDue[d][s];
+			}
+		}
+	}
+	return (due);
+}
+
+/* ---- deviceCommands() ---------------------------------------
+* Description:
+*	Act on every command written since the last look. Any command
+*	acknowledges the previous result, as on uARM. Command
+*	registers are cleared once read, which uARM does not do but
+*	nothing reads them back.
+* --------------------------------- end deviceCommands() ---- */
+HIDDEN void deviceCommands(){
+	int d;
+	unsigned int command;
+
+	for(d = 0; d < DEV_USED_INTS * DEV_PER_INT; d++){
+		devreg_t *device = (devreg_t *) (PHYSADDR(DEV_REG_START) + (d * DEV_REG_SIZE));
+
+		if(d >= (IL_TERMINAL - DEV_IL_START) * DEV_PER_INT){
+			command = device->term.transm_command;
+			device->term.transm_command = 0;
+			if((command & DEVSTATUSMASK) == ACK){
+				device->term.transm_status = DEV_S_READY;
+				setPending(d, 1, FALSE);
+			}
+			else if((command & DEVSTATUSMASK) == PRINTCHR){
+				setPending(d, 1, FALSE);
+				termOutput(d % DEV_PER_INT, (char) (command >> 8));
+				device->term.transm_status = DEVBUSY;
+				startOperation(d, 1, operationTicks(d, TERMTICKS), CHARDONE | (command & 0xFF00));
+			}
+
+			command = device->term.recv_command;
+			device->term.recv_command = 0;
+			if((command & DEVSTATUSMASK) == ACK){
+				device->term.recv_status = DEV_S_READY;
+				setPending(d, 0, FALSE);
+			}
+			else if((command & DEVSTATUSMASK) == RECEIVECHR){
+				setPending(d, 0, FALSE);
+				device->term.recv_status = DEVBUSY; // nobody ever types
+			}
+		}
+		else{
+			command = device->dtp.command;
+			device->dtp.command = 0;
+			if((command & DEVSTATUSMASK) == ACK){
+				setPending(d, 0, FALSE);
+			}
+			else if(command != 0){
+				setPending(d, 0, FALSE);
+				device->dtp.status = DEVBUSY;
+				startOperation(d, 0, operationTicks(d, DEVTICKS), DEV_S_READY);
+			}
+		}
+	}
+}
+
+/* ---- deviceCompletions() ---------------------------------------
+* Description:	finish every operation due by now and raise its interrupt
+* --------------------------------- end deviceCompletions() ---- */
+HIDDEN void deviceCompletions(){
+	int d, s;
+
+	for(d = 0; d < DEV_USED_INTS * DEV_PER_INT; d++){
+		devreg_t *device = (devreg_t *) (PHYSADDR(DEV_REG_START) + (d * DEV_REG_SIZE));
+
+		for(s = 0; s < TERMSUBDEVS; s++){
+			if(deviceDue[d][s] > simClock){
+				continue;
+			}
+			deviceDue[d][s] = NOEVENT;
+			if(s == 1){
+				device->term.transm_status = deviceResult[d][s];
+			}
+			else{
+				device->dtp.status = deviceResult[d][s]; // (the same word as recv_status)
+			}
+			setPending(d, s, TRUE);
+		}
+	}
+}
+
+/* ---- startOperation() ---------------------------------------
+* Description:	device d's sub-device will finish with result in ticks
+* --------------------------------- end startOperation() ---- */
+HIDDEN void startOperation(int device, int sub, unsigned long long ticks, unsigned int result){
+	deviceDue[device][sub] = simClock + ticks;
+	deviceResult[device][sub] = result;
+}
+
+/* ---- operationTicks() ---------------------------------------
+* Description:	how long device d's next operation takes
+* --------------------------------- end operationTicks() ---- */
+HIDDEN unsigned long long operationTicks(int device, unsigned long long ticks){
+	if(serviceTime != NULL){
+		ticks = serviceTime(DEV_IL_START + (device / DEV_PER_INT), device % DEV_PER_INT);
+	}
+	return (ticks);
+}
+
+/* ---- setPending() ---------------------------------------
+* Description:
+*	Set or clear a sub-device's result and with it device d's
+*	bit in its line's bitmap, which stays on while either half
+*	of a terminal has a result not acknowledged.
+* --------------------------------- end setPending() ---- */
+HIDDEN void setPending(int device, int sub, BOOL on){
+	unsigned int *bitmap = ((unsigned int *) DISKINTMAP) + (device / DEV_PER_INT);
+	unsigned int bit = 1 << (device % DEV_PER_INT);
+
+	devicePending[device][sub] = on;
+	if(devicePending[device][0] || devicePending[device][1]){
+		*bitmap = *bitmap | bit;
+	}
+	else{
+		*bitmap = *bitmap & ~bit;
+	}
+}
+
+/* ---- termOutput() ---------------------------------------
+* Description:	a character sent to a terminal
+* --------------------------------- end termOutput() ---- */
+HIDDEN void termOutput(int terminal, char c){
+	char name[16];
+
+	if(quiet){
+		return;
+	}
+	if(termFile[terminal] == NULL){
+		snprintf(name, sizeof(name), "term%d.host", terminal);
+		termFile[terminal] = fopen(name, "w");
+	}
+	if(termFile[terminal] != NULL){
+		fputc(c, termFile[terminal]);
+	}
+	if(terminal == 0){
+		putchar(c);
+	}
+}
+
+/* ---- hostNs() ---------------------------------------
+* Return:		the host's monotonic clock, in ns
+* --------------------------------- end hostNs() ---- */
+HIDDEN unsigned long long hostNs(){
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (((unsigned long long) now.tv_sec * 1000000000ULL) + now.tv_nsec);
+}
@@ -0,0 +1,54 @@
+#ifndef UARM_LIBUARM_H
+#define UARM_LIBUARM_H
+
+#define UARMHOST	1	/* for code that runs both here and on uARM */
+
+/************************* LIBUARM.H *****************************
+*
+*  Mock of uARM's libuarm.h for the host build. The ROM services
+*  keep their uARM names and signatures; host/uarm/libuarm.c
+*  implements them over a simulated clock, timer and device
+*  registers, running each process as a host coroutine.
+*
+*  The uarm*() calls at the end exist only in the host build:
+*  the harness boots the nucleus with uarmRun(), process code
+*  spends simulated CPU time with uarmCompute(), and the rest
+*  configure the simulated machine before it is powered on.
+*  Programs that never power it on (phase 1 ones) may still call
+*  tprint(), HALT() and PANIC(), and time themselves with
+*  uarmCycles().
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+extern unsigned int SYSCALL (unsigned int number, unsigned int arg1, unsigned int arg2, unsigned int arg3);
+extern void LDST (void *state);
+extern void STST (void *state);
+extern void WAIT ();
+extern void HALT ();
+extern void PANIC ();
+
+extern unsigned int getTODHI ();
+extern unsigned int getTODLO ();
+extern unsigned int getTIMER ();
+extern unsigned int setTIMER (unsigned int timer);
+extern unsigned int getSTATUS ();
+extern unsigned int setSTATUS (unsigned int status);
+extern unsigned int getCAUSE ();
+extern unsigned int getCONTROL ();
+extern unsigned int setCONTROL (unsigned int control);
+extern void tprint (char *s);
+
+/********************* Host build only *********************/
+extern int uarmRun (void (*boot)());
+extern void uarmCompute (unsigned int ticks);
+extern unsigned long long uarmClock ();
+extern void uarmServiceTime (unsigned int (*ticks)(int line, int device));
+extern void uarmKernelCost (unsigned int ticks);
+extern void uarmQuiet (int on);
+extern unsigned long long uarmCycles ();
+extern unsigned int uarmCyclesPerUs ();
+
+/***************************************************************/
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef UARM_CONST_H
+#define UARM_CONST_H
+
+/************************* UARMCONST.H *****************************
+*
+*  Mock of uARM's uARMconst.h for the host build: the processor
+*  and device constants the nucleus and its test programs use.
+*
+*  Written by Thomas Reichman, Ajiri Obaebor
+*/
+
+#define STATUS_USER_MODE		0x00000010
+#define STATUS_SYS_MODE			0x0000001F
+#define STATUS_ALL_INT_DISABLE(status)	((status) | 0x000000C0)
+#define STATUS_ALL_INT_ENABLE(status)	((status) & ~0x000000C0)
+
+#define CP15_VM_ON				0x00000001
+
+#define EXC_RESERVEDINSTR		20
+#define BUSERROR				6
+
+#define DEV_S_READY				1
+#define DEV_C_ACK				1
+
+#ifndef NULL
+#define NULL					((void *) 0)
+#endif
+
+#endif
@@ -12,6 +12,12 @@
 *				between lists when they become (in)active.
 *				A semaphore is defined as "active" if there is at least one ProcBlk
 *				on the process queue associated it.
+*
+*				Built with -DSEMSTATS, the module also keeps contention
+*				statistics per semaphore address. They live in their own
+*				small hash table rather than in the semd_t's, since a
+*				descriptor goes back on the free list every time its
+*				semaphore has no waiters and the history would go with it.
 * 
 * AUTHORS:		Thomas Reichman; Ajiri Obaebor
 *				Some descriptions adapted from Michael Goldweber
@@ -39,6 +45,11 @@ HIDDEN semd_t *semd_h, *semdFree_h;
 	// semd_h: Active Semaphore list
 	// semdFree_h: Semaphore Free List
 
+#ifdef SEMSTATS
+// Semaphore Statistics, open addressed on the semaphore address
+HIDDEN semstat_t semStats[SEMSTATSIZE];
+#endif
+
 //////////////////// FUNCTION DECLARATIONS ////////////////////
 /********************* Public Functions **********************/
 void initASL();
@@ -50,6 +61,12 @@ pcb_PTR headBlocked(int *semAdd);
 HIDDEN semd_t *findPrevSemd(int *semAdd);
 HIDDEN void freeSemd(semd_t *semd);
 HIDDEN semd_t *allocateSemd();
+#ifdef SEMSTATS
+void semStatP(int *semAdd, pcb_PTR p, BOOL contended, int now);
+void semStatV(int *semAdd, pcb_PTR p, pcb_PTR woken, int blockedAt, int now);
+int semStatTop(semstat_t *buffer, int n);
+HIDDEN semstat_t *findSemStat(int *semAdd);
+#endif
 ////////////////////// End Declarations ///////////////////////
 
 
@@ -86,8 +103,8 @@ void initASL(){
 	bottomDummyNode->s_next = NULL;
 	bottomDummyNode->s_semAdd = (int *) 0xFFFFFF;
 
+	topDummyNode->s_next = bottomDummyNode; // every search stops at the bottom one
 	semd_h = topDummyNode;	// Set the head to the top dummy node
-							// Set the tail to the bottom dummy node?
 }
 
 /* ---- insertBlocked() ---------------------------------------
@@ -324,4 +341,125 @@ HIDDEN semd_t *allocateSemd() {
 	freeSemd->s_semAdd = NULL;
 	freeSemd->s_procQ = NULL;
 	return freeSemd;	
-}
\ No newline at end of file
+}
+
+#ifdef SEMSTATS
+////////////////////// Semaphore Statistics ///////////////////////
+
+/* ---- semStatP() --------------------------------------------
+* Parameters:	int *semAdd, pcb_PTR p, BOOL contended, int now
+* Type:			Public
+* Return:		None
+* Description:
+* 	Count a P by p on semAdd. If it got straight through, p holds
+*	semAdd from now until it V's it (if it ever does).
+* -------------------------------------- end semStatP() ---- */
+void semStatP(int *semAdd, pcb_PTR p, BOOL contended, int now) {
+	semstat_t *stat = findSemStat(semAdd);
+	if (stat == NULL) {
+		return; // table full, this one goes untracked
+	}
+
+	stat->ss_P++;
+	if (contended) {
+		stat->ss_contended++;
+	}
+	else {
+		stat->ss_holder = p->p_pid;
+		stat->ss_holdStart = now;
+	}
+}
+
+/* ---- semStatV() --------------------------------------------
+* Parameters:	int *semAdd, pcb_PTR p, pcb_PTR woken (or NULL),
+*				int blockedAt, int now
+* Type:			Public
+* Return:		None
+* Description:
+* 	Count a V by p on semAdd. If p was the one that got through
+*	the last P, that ends a hold. If it woke a process that
+*	blocked at blockedAt, that ends a wait, and the woken
+*	process is the holder from now on.
+* -------------------------------------- end semStatV() ---- */
+void semStatV(int *semAdd, pcb_PTR p, pcb_PTR woken, int blockedAt, int now) {
+	semstat_t *stat = findSemStat(semAdd);
+	if (stat == NULL) {
+		return;
+	}
+
+	if ((stat->ss_holder != 0) && (stat->ss_holder == p->p_pid)) {
+		stat->ss_holdTotal = stat->ss_holdTotal + (now - stat->ss_holdStart);
+		stat->ss_holds++;
+		stat->ss_holder = 0;
+	}
+
+	if (woken != NULL) {
+		int wait = now - blockedAt;
+		stat->ss_waitTotal = stat->ss_waitTotal + wait;
+		if (wait > stat->ss_waitMax) {
+			stat->ss_waitMax = wait;
+		}
+		stat->ss_holder = woken->p_pid; // the P it was blocked in just went through
+		stat->ss_holdStart = now;
+	}
+}
+
+/* ---- semStatTop() --------------------------------------------
+* Parameters:	semstat_t *buffer, int n
+* Type:			Public
+* Return:		number of entries written to buffer
+* Description:
+* 	Copy out the n semaphores with the most total wait time,
+*	worst first, by insertion into buffer (n is small).
+*	n comes straight from a SYS call: nothing is written for n <= 0.
+* -------------------------------------- end semStatTop() ---- */
+int semStatTop(semstat_t *buffer, int n) {
+	int found = 0;
+
+	if (n <= 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < SEMSTATSIZE; i++) {
+		if (semStats[i].ss_semAdd == NULL) {
+			continue;
+		}
+		if ((found == n) && (semStats[i].ss_waitTotal <= buffer[n - 1].ss_waitTotal)) {
+			continue; // not in the top n
+		}
+
+		int j = (found < n) ? found++ : (n - 1); // slot to fill, dropping the last if full
+		while ((j > 0) && (buffer[j - 1].ss_waitTotal < semStats[i].ss_waitTotal)) {
+			buffer[j] = buffer[j - 1];
+			j--;
+		}
+		buffer[j] = semStats[i];
+	}
+	return found;
+}
+
+/* ---- findSemStat() --------------------------------------------
+* Parameters:	int *semAdd
+* Type:			Private
+* Return:		semstat_t * or NULL if the table is full
+* Description:
+* 	Find semAdd's entry, claiming an empty one the first time
+*	semAdd is seen. Entries are never removed, so probing can
+*	stop at the first empty one.
+* -------------------------------------- end findSemStat() ---- */
+HIDDEN semstat_t *findSemStat(int *semAdd) {
+	unsigned int slot = (((unsigned int) semAdd) >> 2) & (SEMSTATSIZE - 1);
+
+	for (int probes = 0; probes < SEMSTATSIZE; probes++) {
+		if (semStats[slot].ss_semAdd == semAdd) {
+			return &(semStats[slot]);
+		}
+		if (semStats[slot].ss_semAdd == NULL) {
+			semStats[slot].ss_semAdd = semAdd;
+			return &(semStats[slot]);
+		}
+		slot = (slot + 1) & (SEMSTATSIZE - 1);
+	}
+	return (NULL);
+}
+#endif
@@ -0,0 +1,228 @@
+/*********************************P1BENCH.C*******************************
+ *
+ *	Benchmark program for the modules ASL and pcbQueues (phase 1).
+ *
+ *	Times every phase 1 operation and prints one CSV line per
+ *	benchmark on terminal 0 (through tprint):
+ *		benchmark,n,ops,cycles_per_op,ops_per_sec
+ *	n is the queue length, the number of children or the number
+ *	of active semaphores the operation runs against.
+ *
+ *	Built by "make bench" into kernel.bench.uarm, where the TOD
+ *	counts cycles, and by "make p1bench" in host/ into
+ *	p1bench.host, where the host's cycle counter is used.
+ *
+ *	p1test checks these operations are right; this is the
+ *	baseline to compare every change to them against.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "uarm/libuarm.h"
+#include "uarm/arch.h"
+#include "../e/pcb.e"
+#include "../e/asl.e"
+
+
+#define EOS			'\0'
+#define MAXDIGITS	10
+
+#ifdef UARMHOST
+#define ROUNDS		100000		/* operations per benchmark */
+#define NOW()		((unsigned int) uarmCycles())
+#define TICKSPERUS	(uarmCyclesPerUs())
+#else
+#define ROUNDS		1000
+#define NOW()		(getTODLO())
+#define TICKSPERUS	(*((unsigned int *) BUS_REG_TIME_SCALE))
+#endif
+
+int		sem[MAXPROC];			/* one more than can ever be active */
+pcb_t	*procp[MAXPROC];
+
+
+/* print an unsigned number in decimal */
+void printNum(unsigned int n) {
+	char	buf[MAXDIGITS + 1];
+	int		i = MAXDIGITS;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n = n / 10;
+	} while (n != 0);
+	tprint(&buf[i]);
+}
+
+/* one CSV line: ticks spent on ops operations against n */
+void report(char *name, int n, unsigned int ops, unsigned int ticks) {
+	/* tenths of a cycle, without overflowing 32 bits on uARM */
+	unsigned int tenths = ((ticks / ops) * 10) + (((ticks % ops) * 10) / ops);
+
+	if (tenths == 0)
+		tenths = 1;
+	tprint(name);
+	tprint(",");
+	printNum(n);
+	tprint(",");
+	printNum(ops);
+	tprint(",");
+	printNum(tenths / 10);
+	tprint(".");
+	printNum(tenths % 10);
+	tprint(",");
+	printNum(((TICKSPERUS * 100000) / tenths) * 100);
+	tprint("\n");
+}
+
+/* allocate all MAXPROC ProcBlks into procp[] */
+void allocAll() {
+	int i;
+
+	for (i = 0; i < MAXPROC; i++)
+		if ((procp[i] = allocPcb()) == NULL) {
+			tprint("p1bench: allocPcb: unexpected NULL\n");
+			PANIC();
+		}
+}
+
+/* and give them back */
+void freeAll() {
+	int i;
+
+	for (i = 0; i < MAXPROC; i++)
+		freePcb(procp[i]);
+}
+
+
+/* allocPcb + freePcb pairs, every ProcBlk free */
+void benchAlloc() {
+	unsigned int	start, end;
+	pcb_t			*p;
+	int				i;
+
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++) {
+		p = allocPcb();
+		freePcb(p);
+	}
+	end = NOW();
+	report("allocPcb+freePcb", MAXPROC, ROUNDS, end - start);
+}
+
+/* insertProcQ + removeProcQ on a queue of length n */
+void benchProcQ(int n) {
+	unsigned int	start, end;
+	pcb_t			*tp = mkEmptyProcQ();
+	pcb_t			*p;
+	int				i;
+
+	allocAll();
+	p = procp[n - 1];
+	for (i = 0; i < n - 1; i++)
+		insertProcQ(&tp, procp[i]);
+
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++) {
+		insertProcQ(&tp, p);
+		p = removeProcQ(&tp);		/* the queue goes round, n long at its longest */
+	}
+	end = NOW();
+	report("insertProcQ+removeProcQ", n, ROUNDS, end - start);
+
+	insertProcQ(&tp, p);
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++)
+		insertProcQ(&tp, outProcQ(&tp, procp[(n - 1) / 2]));	/* from the middle */
+	end = NOW();
+	report("outProcQ+insertProcQ", n, ROUNDS, end - start);
+
+	while (removeProcQ(&tp) != NULL)
+		;
+	freeAll();
+}
+
+/* insertChild + removeChild, and outChild, with n children */
+void benchChild(int n) {
+	unsigned int	start, end;
+	pcb_t			*parent, *p;
+	int				i;
+
+	allocAll();
+	parent = procp[MAXPROC - 1];
+	p = procp[n - 1];
+	for (i = 0; i < n - 1; i++)
+		insertChild(parent, procp[i]);
+
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++) {
+		insertChild(parent, p);
+		p = removeChild(parent);
+	}
+	end = NOW();
+	report("insertChild+removeChild", n, ROUNDS, end - start);
+
+	insertChild(parent, p);
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++)
+		insertChild(parent, outChild(procp[(n - 1) / 2]));
+	end = NOW();
+	report("outChild+insertChild", n, ROUNDS, end - start);
+
+	while (removeChild(parent) != NULL)
+		;
+	freeAll();
+}
+
+/* insertBlocked + removeBlocked, and outBlocked, with n semaphores active */
+void benchASL(int n) {
+	unsigned int	start, end;
+	int				*target = &sem[n - 1];	/* the highest address: the longest search */
+	int				i;
+
+	allocAll();
+	for (i = 0; i < n - 1; i++)
+		insertBlocked(&sem[i], procp[i]);
+
+	/* the semaphore's descriptor is allocated and freed every time */
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++) {
+		insertBlocked(target, procp[n - 1]);
+		removeBlocked(target);
+	}
+	end = NOW();
+	report("insertBlocked+removeBlocked", n, ROUNDS, end - start);
+
+	start = NOW();
+	for (i = 0; i < ROUNDS; i++) {
+		insertBlocked(target, procp[n - 1]);
+		outBlocked(procp[n - 1]);
+	}
+	end = NOW();
+	report("insertBlocked+outBlocked", n, ROUNDS, end - start);
+
+	for (i = 0; i < n - 1; i++)
+		removeBlocked(&sem[i]);
+	freeAll();
+}
+
+
+void main() {
+	int lengths[] = {1, 2, 5, 10, MAXPROC - 1};
+	int i;
+
+	initPcbs();
+	initASL();
+
+	tprint("benchmark,n,ops,cycles_per_op,ops_per_sec\n");
+	benchAlloc();
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+		benchProcQ(lengths[i]);
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+		benchChild(lengths[i]);
+	for (i = 1; i <= MAXPROC; i++)
+		benchASL(i);
+
+	HALT();
+}
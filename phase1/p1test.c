@@ -15,7 +15,7 @@
 #include "../h/const.h"
 #include "../h/types.h"
 
-#include "/usr/include/uarm/libuarm.h"
+#include "uarm/libuarm.h"
 #include "../e/pcb.e"
 #include "../e/asl.e"
 
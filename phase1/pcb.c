@@ -19,6 +19,8 @@
 
 ///////////////////////// DEFINITONS //////////////////////////
 pcb_PTR pcbList_h;			// Initialize PCB free list with a pointer to its head
+HIDDEN pcb_t procTable[MAXPROC];	// Every ProcBlk there will ever be
+HIDDEN int pidSerial;		// Bumped on every allocation so PIDs are never reused
 //////////////////// FUNCTION DECLARATIONS ////////////////////
 /********************* Public Functions **********************/
 pcb_PTR allocPcb();
@@ -27,6 +29,7 @@ void initPcbs();
 int emptyProcQ(pcb_PTR tp);
 pcb_PTR mkEmptyProcQ();
 pcb_PTR headProcQ(pcb_PTR tp);
+int procQLength(pcb_PTR tp);
 void insertProcQ(pcb_PTR *tp, pcb_PTR p);
 pcb_PTR removeProcQ(pcb_PTR *tp);
 pcb_PTR outProcQ(pcb_PTR *tp, pcb_PTR p);
@@ -34,6 +37,12 @@ int emptyChild(pcb_PTR p);
 void insertChild(pcb_PTR prnt, pcb_PTR p);
 pcb_PTR removeChild(pcb_PTR prnt);
 pcb_PTR outChild(pcb_PTR p);
+void insertGroup(pcb_PTR *tp, pcb_PTR p);
+pcb_PTR outGroup(pcb_PTR *tp, pcb_PTR p);
+pcb_PTR headGroup(pcb_PTR tp);
+pcb_PTR nextGroup(pcb_PTR tp, pcb_PTR p);
+pcb_PTR findPcb(int pid);
+pcb_PTR pcbSlot(int slot);
 ////////////////////// End Declarations ///////////////////////
 
 
@@ -54,6 +63,8 @@ pcb_PTR outChild(pcb_PTR p);
 *	a ProcBlk when itgets reallocated.
 * -------------------------------------- end allocPcb() ---- */
 pcb_PTR allocPcb(){
+	int i;
+
 	if (pcbList_h == NULL){
 		return (NULL);
 	}
@@ -66,9 +77,40 @@ pcb_PTR allocPcb(){
 	unusedPCB->p_child = NULL;
 	unusedPCB->p_nextSib = NULL;
 	unusedPCB->p_prevSib = NULL;	
+	unusedPCB->p_semAdd = NULL; // a ProcBlk killed while blocked keeps its old one
 
 	//PHASE 2 STUFF
 	unusedPCB->p_time = 0; // microseconds
+	unusedPCB->p_childTime = 0;
+
+	// PID = serial * MAXPROC + slot, so findPcb() never has to search
+	pidSerial++;
+	unusedPCB->p_pid = (pidSerial * MAXPROC) + (unusedPCB - procTable);
+
+	unusedPCB->p_grpID = 0;
+	unusedPCB->p_grpNext = NULL;
+	unusedPCB->p_grpPrev = NULL;
+	unusedPCB->p_suspended = FALSE;
+	unusedPCB->p_sigPending = 0;
+
+	unusedPCB->p_upcall = NULL;
+
+	unusedPCB->p_budget = 0;
+	unusedPCB->p_budgetUsed = 0;
+	unusedPCB->p_budgetFlags = 0;
+	unusedPCB->p_budgetEpoch = 0;
+	unusedPCB->p_throttles = 0;
+	unusedPCB->p_throttled = FALSE;
+	unusedPCB->p_dispatches = 0;
+	unusedPCB->p_volSwitches = 0;
+	unusedPCB->p_involSwitches = 0;
+	unusedPCB->p_readyTime = 0;
+	for (i = 0; i < BLOCKCATS; i++){
+		unusedPCB->p_blockedTime[i] = 0;
+	}
+	unusedPCB->p_blockCat = NOTBLOCKED;
+	unusedPCB->p_stamp = 0;
+	unusedPCB->p_wakeClass = NOWAKE;
 
 	return unusedPCB;
 }
@@ -82,6 +124,8 @@ pcb_PTR allocPcb(){
 *	p onto the pcbFree list.  
 * --------------------------------------- end freePcb() ---- */
 void freePcb (pcb_PTR p) {
+	p->p_pid = 0; // stale PIDs must not find this ProcBlk again
+
 	// More effecient to procrasinate the dishes!
 	insertProcQ(&(pcbList_h), p);
 }
@@ -98,7 +142,7 @@ void freePcb (pcb_PTR p) {
 *	initialization. 						   
 * -------------------------------------- end initPcbs() ---- */
 void initPcbs() {
-	static pcb_t procTable[MAXPROC];
+	pidSerial = 0;
 
 	pcbList_h = mkEmptyProcQ(); // Create the list
 
@@ -150,6 +194,29 @@ pcb_PTR headProcQ(pcb_PTR tp) {
 	return (tp->p_next);
 }
 
+/* ---- procQLength() -----------------------------------------
+* Parameters: 	pcb_PTR tp
+* Type: 		Public
+* Return:		int
+* Description:
+*	Return how many ProcBlks are on the process
+*	queue whose tail is pointed to by tp.
+* ----------------------------------- end procQLength() ---- */
+int procQLength(pcb_PTR tp) {
+	int length = 0;
+	pcb_PTR p;
+
+	if (emptyProcQ(tp)){
+		return (0);
+	}
+	p = tp;
+	do {
+		length++;
+		p = p->p_next;
+	} while (p != tp);
+	return (length);
+}
+
 /* ---- insertProcQ() -----------------------------------------
 * Parameters: 	pcb_PTR *tp, pcb_PTR p
 * Type: 		Public
@@ -388,4 +455,134 @@ pcb_PTR outChild(pcb_PTR p){
 	p->p_nextSib = NULL;
 	p->p_prnt = NULL;
 	return p;
-}
\ No newline at end of file
+}
+
+/* ---- insertGroup() -----------------------------------------
+* Parameters: 	pcb_PTR *tp, pcb_PTR p
+* Type: 		Public
+* Return:		None
+* Description:
+*	Insert the ProcBlk pointed to by p at the tail of the
+*	group membership list whose tail-pointer is pointed to by tp.
+*	Works like insertProcQ(), but through the p_grpNext/p_grpPrev
+*	links so a process can be on a group list and a process
+*	queue at the same time.
+* ----------------------------------- end insertGroup() ---- */
+void insertGroup(pcb_PTR *tp, pcb_PTR p){
+	// Case 1: Group is empty
+	if (*tp == NULL){
+		p->p_grpNext = p;
+		p->p_grpPrev = p;
+	}
+	// Case 2: Group is NOT empty - weave in after the tail
+	else{
+		p->p_grpNext = (*tp)->p_grpNext;
+		(*tp)->p_grpNext->p_grpPrev = p;
+		(*tp)->p_grpNext = p;
+		p->p_grpPrev = *tp;
+	}
+
+	*tp = p;						// New member is always the tail
+}
+
+/* ---- outGroup() --------------------------------------------
+* Parameters: 	pcb_PTR *tp, pcb_PTR p
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Remove the ProcBlk pointed to by p from the group membership
+*	list whose tail-pointer is pointed to by tp. Unlike outProcQ()
+*	there is no search: p_grpID tells the caller which list p is
+*	on, so removal is O(1). Return NULL if p is on no group list,
+*	otherwise return p.
+* -------------------------------------- end outGroup() ---- */
+pcb_PTR outGroup(pcb_PTR *tp, pcb_PTR p){
+	// Case 1: p isn't a member of anything
+	if ((*tp == NULL) || (p->p_grpNext == NULL)){
+		return (NULL);
+	}
+	// Case 2: p is the only member
+	if (p->p_grpNext == p){
+		*tp = NULL;
+	}
+	// Case 3: Bridge the gap, moving the tail back if p was it
+	else{
+		p->p_grpNext->p_grpPrev = p->p_grpPrev;
+		p->p_grpPrev->p_grpNext = p->p_grpNext;
+		if (*tp == p){
+			*tp = p->p_grpPrev;
+		}
+	}
+	p->p_grpNext = NULL;
+	p->p_grpPrev = NULL;
+	return p;
+}
+
+/* ---- headGroup() -------------------------------------------
+* Parameters: 	pcb_PTR tp
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Return a pointer to the first member of the group whose
+*	tail is pointed to by tp without removing it.
+*	Return NULL if the group is empty.
+* ------------------------------------- end headGroup() ---- */
+pcb_PTR headGroup(pcb_PTR tp){
+	if (tp == NULL){
+		return (NULL);
+	}
+	return (tp->p_grpNext);
+}
+
+/* ---- nextGroup() -------------------------------------------
+* Parameters: 	pcb_PTR tp, pcb_PTR p
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Return the member after p in the group whose tail is pointed
+*	to by tp, or NULL if p is the tail. Starting from headGroup(),
+*	this visits every member once without wrapping around.
+* ------------------------------------- end nextGroup() ---- */
+pcb_PTR nextGroup(pcb_PTR tp, pcb_PTR p){
+	if (p == tp){
+		return (NULL);
+	}
+	return (p->p_grpNext);
+}
+
+/* ---- findPcb() ---------------------------------------------
+* Parameters: 	int pid
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Return the live ProcBlk whose PID is pid, or NULL if there
+*	is none. The PID encodes the ProcBlk's slot in procTable, so
+*	this is a single lookup rather than a search.
+* --------------------------------------- end findPcb() ---- */
+pcb_PTR findPcb(int pid){
+	if (pid <= 0){
+		return (NULL);
+	}
+	pcb_PTR candidate = &(procTable[pid % MAXPROC]);
+	if (candidate->p_pid != pid){	// slot was freed or reused since
+		return (NULL);
+	}
+	return candidate;
+}
+
+/* ---- pcbSlot() ---------------------------------------------
+* Parameters: 	int slot
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Return the ProcBlk in procTable[slot] if it is in use, or NULL
+*	if it is on the free list (or slot is out of range). Walking
+*	slots 0..MAXPROC-1 visits every live process exactly once,
+*	without following any queue or tree.
+* --------------------------------------- end pcbSlot() ---- */
+pcb_PTR pcbSlot(int slot){
+	if ((slot < 0) || (slot >= MAXPROC) || (procTable[slot].p_pid == 0)){
+		return (NULL);
+	}
+	return (&(procTable[slot]));
+}
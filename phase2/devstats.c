@@ -0,0 +1,126 @@
+/**************************************************************
+* FILENAME:		devstats.c
+*
+* DESCRIPTION:	Device Statistics Module for JaeOS
+*
+* NOTES:		Keeps utilization and throughput figures for every entry
+*				of the device semaphore table: each disk, tape, network
+*				and printer, both halves of each terminal and the
+*				pseudo-clock.
+*
+*				Processes start their own I/O by writing the device
+*				register and then SYS 8, so the nucleus first sees an
+*				operation when its issuer blocks in waitIO(). An
+*				operation counts as outstanding from then until the
+*				interrupt that wakes its waiter. The device is busy while
+*				anything is outstanding and idle otherwise, and the
+*				number outstanding over time gives the queue depth.
+*
+*				Everything is updated in waitIO() / waitClock() and in
+*				the interrupt handlers, using TOD reads they already do.
+*				SYS 31 copies the table out, optionally clearing it.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/devstats.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN devstat_t devStats[MAXSEMA4];
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void devStatIssue(int semaphoreIndex, int now);
+//	   void devStatComplete(int semaphoreIndex, BOOL error, int now);
+//	   void devStatRead(devstat_t *report, BOOL reset, int now);
+/********************* Private Functions *********************/
+HIDDEN void catchUp (devstat_t *device, int now);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- devStatIssue() ---------------------------------------
+* Parameters: 	int semaphoreIndex, int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	A process just blocked waiting on this device.
+* --------------------------------- end devStatIssue() ---- */
+void devStatIssue(int semaphoreIndex, int now){
+	devstat_t *device = &(devStats[semaphoreIndex]);
+
+	catchUp(device, now);
+	device->d_outstanding++;
+}
+
+/* ---- devStatComplete() ---------------------------------------
+* Parameters: 	int semaphoreIndex, BOOL error, int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	This device's interrupt just woke its waiter (with an
+*	error status, if error).
+* --------------------------------- end devStatComplete() ---- */
+void devStatComplete(int semaphoreIndex, BOOL error, int now){
+	devstat_t *device = &(devStats[semaphoreIndex]);
+
+	catchUp(device, now);
+	if(device->d_outstanding > 0){
+		device->d_outstanding--;
+	}
+	device->d_ops++;
+	if(error){
+		device->d_errors++;
+	}
+}
+
+/* ---- devStatRead() ---------------------------------------
+* Parameters: 	devstat_t *report (MAXSEMA4 of them), BOOL reset, int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	Bring every device up to now and copy the table out.
+*	A reset clears the counters but keeps d_outstanding, since
+*	those processes are still waiting.
+* --------------------------------- end devStatRead() ---- */
+void devStatRead(devstat_t *report, BOOL reset, int now){
+	int i;
+
+	for(i = 0; i < MAXSEMA4; i++){
+		catchUp(&(devStats[i]), now);
+		report[i] = devStats[i];
+
+		if(reset){
+			devStats[i].d_ops = 0;
+			devStats[i].d_errors = 0;
+			devStats[i].d_busyTime = 0;
+			devStats[i].d_idleTime = 0;
+			devStats[i].d_depthTime = 0;
+		}
+	}
+}
+
+/* ---- catchUp() ---------------------------------------
+* Parameters: 	devstat_t *device, int now
+* Type: 		Private
+* Return:		None
+* Description:
+*	Charge the time since the device last changed to busy or
+*	idle, and to the queue depth integral, at the old depth.
+* --------------------------------- end catchUp() ---- */
+HIDDEN void catchUp(devstat_t *device, int now){
+	int elapsed = now - device->d_lastChange;
+
+	if(device->d_outstanding > 0){
+		device->d_busyTime = device->d_busyTime + elapsed;
+		device->d_depthTime = device->d_depthTime + (device->d_outstanding * elapsed);
+	}
+	else{
+		device->d_idleTime = device->d_idleTime + elapsed;
+	}
+	device->d_lastChange = now;
+}
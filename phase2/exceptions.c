@@ -12,6 +12,27 @@
 *				simulate a PGM trap in User mode,
 *				and are passed up or killed if SYS 9+
 *
+*				SYS 10-15 manage process groups: every member of a
+*				group can be suspended, resumed, signaled or killed
+*				with a single trap by walking the group's membership list.
+*				SYS 16-18 let a process give up the CPU cooperatively,
+*				either to everyone or directly to a named ready process.
+*				SYS 19 registers an upcall: when the process blocks in a
+*				P or a SYS 8, a fresh activation is started from that state
+*				so a user-level thread library can keep running its threads.
+*				SYS 20-21 set and read CPU budgets (see scheduler.c).
+*				SYS 22 is SYS 6 plus the time of terminated descendants.
+*				SYS 23 copies out one record per live process.
+*				SYS 24 reads a process' scheduling counters.
+*				SYS 25 drains the kernel trace ring (see trace.c).
+*				SYS 26-28 run the PC-sampling profiler (see profile.c).
+*				SYS 29 reads the wake up latency histograms (see latency.c).
+*				SYS 30 reports the most contended semaphores (-DSEMSTATS).
+*				SYS 31 reports per-device utilization (see devstats.c).
+*				SYS 32 reports where the nucleus spends its time (see ktime.c).
+*				SYS 33 reports load averages and idle time (see loadavg.c).
+*				SYS 34 reads the kernel log (see klog.c).
+*
 *				All SYS calls are handled in their own function,
 *				but may call helper functions.
 *
@@ -32,14 +53,23 @@
 
 #include "../e/pcb.e"
 #include "../e/asl.e"
+#include "../e/record.e"
 #include "../e/initial.e"
 #include "../e/scheduler.e"
 #include "../e/exceptions.e"
+#include "../e/trace.e"
+#include "../e/profile.e"
+#include "../e/latency.e"
+#include "../e/devstats.e"
+#include "../e/ktime.e"
+#include "../e/loadavg.e"
+#include "../e/flight.e"
+#include "../e/klog.e"
 #include "../e/interrupts.e"
 
 #include "../h/const.h"
 #include "../h/types.h"
-#include "/usr/include/uarm/libuarm.h"
+#include "uarm/libuarm.h"
 
 ///////////////////////// GLOBAL DEFINITONS //////////////////////////
 // Allow old areas to be easily accessed throughout all functions
@@ -55,8 +85,11 @@ state_t *oldSYS = (state_t *) SYSOLDADD;
 //	   void PGMTrapHandler();
 //	   void TLBTrapHandler();
 //	   void SYSCallHandler();
+//	   int depthFirstMurder(pcb_PTR observedProcess);
+//	   void admitCreators();
 /********************* Private Functions *********************/
 HIDDEN void createProcess ();
+HIDDEN void spawnChild ();
 HIDDEN void terminateProcess ();
 HIDDEN void verhogen ();
 HIDDEN void passeren ();
@@ -64,7 +97,32 @@ HIDDEN void spectrapvec ();
 HIDDEN void getCPUTime ();
 HIDDEN void waitClock ();
 HIDDEN void waitIO ();
-HIDDEN void depthFirstMurder (pcb_PTR observedProcess);
+HIDDEN void setGroup ();
+HIDDEN void suspendGroup ();
+HIDDEN void resumeGroup ();
+HIDDEN void signalGroup ();
+HIDDEN void terminateGroup ();
+HIDDEN void getSignals ();
+HIDDEN void yield ();
+HIDDEN void yieldTo ();
+HIDDEN void getPid ();
+HIDDEN void specUpcall ();
+HIDDEN void blockUpcall ();
+HIDDEN void setBudget ();
+HIDDEN void getBudget ();
+HIDDEN void getTimes ();
+HIDDEN void snapshot ();
+HIDDEN void getSchedStats ();
+HIDDEN void readTrace ();
+HIDDEN void startProfile ();
+HIDDEN void stopProfile ();
+HIDDEN void readProfile ();
+HIDDEN void readLatency ();
+HIDDEN void semTop ();
+HIDDEN void deviceStats ();
+HIDDEN void kernelTime ();
+HIDDEN void loadAverage ();
+HIDDEN void readKlog ();
 HIDDEN void passUpOrDie (int trapType, state_t *oldState);
 //////////////////// END TABLE OF CONTENTS ////////////////////
 
@@ -115,6 +173,8 @@ void copyState(state_t* origin, state_t* destination){
 *	Just don't call it when currentProc is NULL!
 * -------------------------------------- end loadState() ---- */
 void loadState(){
+	kernelLeave(); // stop timing this kernel path (if nobody already did)
+	TRACESYSEXIT(); // leaving the nucleus ends any SYS call in progress
 	LDST(&(g_currentProc->p_s));
 }
 
@@ -125,12 +185,17 @@ void loadState(){
 * Description:
 *	Update the p_time field of the current process
 *		and the amount of time remaining.
+*	The same time is charged against any CPU budget covering it.
 * -------------------------------------- end updateTime() ---- */
 void updateTime(){
 	g_endTOD = getTODLO(); 						// endpoint created so we can figure out time difference
 	g_accTime = g_endTOD - g_startTOD; 			// Calculate how much time has passed since the start
 	g_currentProc->p_time = g_currentProc->p_time + g_accTime; // Update that for the current process
 
+	if(g_budgetsInUse){
+		chargeBudgets(g_currentProc, g_accTime); // scheduler() enforces them
+	}
+
 	/* Move start time so that future calculations don't charge for
 	   time already charged to them while still charging them for their time
 	   in here 															*/
@@ -146,6 +211,7 @@ void updateTime(){
 *	It simply gives passUpOrDie() the necessary parameters.
 * --------------------------------- end PGMTrapHandler() ---- */
 void PGMTrapHandler(){
+	kernelEnter(KPPGM);
 	passUpOrDie(PGMTRAP, oldPGM);
 	
 }
@@ -159,6 +225,7 @@ void PGMTrapHandler(){
 *	It simply gives passUpOrDie() the necessary parameters.
 * --------------------------------- end TLBTrapHandler() ---- */
 void TLBTrapHandler(){
+	kernelEnter(KPTLB);
 	passUpOrDie(TLBTRAP, oldTLB);
 	
 }
@@ -169,17 +236,29 @@ void TLBTrapHandler(){
 * Return:		None
 * Description:
 *	There exists 3 potential cases to be handled:
-*		SYS call 9-255: passUpOrDie()
-*		SYS call 1-8 in SYS mode: Handled individually
-*		SYS call 1-8 NOT in SYS mode: Simulate PGMTrap
+*		SYS call 9 or above LASTSYSCALL: passUpOrDie()
+*		Any other SYS call in SYS mode: Handled individually
+*		Any other SYS call NOT in SYS mode: Simulate PGMTrap
+*	SYS 0 and below have no handler and end up as the simulated
+*	PgmTrap too, so they are timed as one.
 * --------------------------------- end SYSCallHandler() ---- */
 void SYSCallHandler(){
 	copyState(oldSYS, &(g_currentProc->p_s)); // current process' state is
 												// now what was stored in oldSYS
 	int SYSNum = oldSYS->a1; // Extract SYS # from A1
+	if((SYSNum > LASTSYSCALL) || (SYSNum == RESERVEDSYS)){
+		kernelEnter(KPPASSUP);
+	}
+	else if((SYSNum <= 0) || ((g_currentProc->p_s.cpsr & SYSMODE) != SYSMODE)){
+		kernelEnter(KPPGM); // becomes a PgmTrap below, counted only as one
+	}
+	else{
+		kernelEnter(SYSNum);
+	}
+	TRACE(TR_SYSENTER, g_currentProc, SYSNum);
 
 	// CASE 1: SYS call number is NOT one of the ones we can handle
-	if(SYSNum > WAITIO){
+	if((SYSNum > LASTSYSCALL) || (SYSNum == RESERVEDSYS)){
 		passUpOrDie(SYSTRAP, oldSYS);
 	}
 	
@@ -188,7 +267,7 @@ void SYSCallHandler(){
 
 		switch(SYSNum){		// Handle each SYS num individually
 			case CREATEPROCESS:
-				createProcess((state_t *) oldSYS->a2);
+				createProcess((state_t *) oldSYS->a2, (BOOL) oldSYS->a3);
 				break;
 
 			case TERMINATEPROCESS:
@@ -218,6 +297,106 @@ void SYSCallHandler(){
 			case WAITIO:
 				waitIO((int *) oldSYS->a2, (state_t *) oldSYS->a3, (state_t *) oldSYS->a4);
 				break;
+
+			case SETGROUP:
+				setGroup((int) oldSYS->a2);
+				break;
+
+			case SUSPENDGROUP:
+				suspendGroup((int) oldSYS->a2);
+				break;
+
+			case RESUMEGROUP:
+				resumeGroup((int) oldSYS->a2);
+				break;
+
+			case SIGNALGROUP:
+				signalGroup((int) oldSYS->a2, (unsigned int) oldSYS->a3);
+				break;
+
+			case TERMINATEGROUP:
+				terminateGroup((int) oldSYS->a2);
+				break;
+
+			case GETSIGNALS:
+				getSignals();
+				break;
+
+			case YIELD:
+				yield();
+				break;
+
+			case YIELDTO:
+				yieldTo((int) oldSYS->a2);
+				break;
+
+			case GETPID:
+				getPid();
+				break;
+
+			case SPECUPCALL:
+				specUpcall((state_t *) oldSYS->a2);
+				break;
+
+			case SETBUDGET:
+				setBudget((int) oldSYS->a2, (int) oldSYS->a3, (int) oldSYS->a4);
+				break;
+
+			case GETBUDGET:
+				getBudget((int) oldSYS->a2, (budget_t *) oldSYS->a3);
+				break;
+
+			case GETTIMES:
+				getTimes((cputime_t *) oldSYS->a2);
+				break;
+
+			case SNAPSHOT:
+				snapshot((procsnap_t *) oldSYS->a2, (int) oldSYS->a3);
+				break;
+
+			case GETSCHEDSTATS:
+				getSchedStats((int) oldSYS->a2, (schedstat_t *) oldSYS->a3);
+				break;
+
+			case READTRACE:
+				readTrace((traceev_t *) oldSYS->a2, (int) oldSYS->a3);
+				break;
+
+			case PROFSTART:
+				startProfile((int) oldSYS->a2, (int) oldSYS->a3);
+				break;
+
+			case PROFSTOP:
+				stopProfile();
+				break;
+
+			case PROFREAD:
+				readProfile((profent_t *) oldSYS->a2, (int) oldSYS->a3);
+				break;
+
+			case READLATENCY:
+				readLatency((lathist_t *) oldSYS->a2, (BOOL) oldSYS->a3);
+				break;
+
+			case SEMTOP:
+				semTop((semstat_t *) oldSYS->a2, (int) oldSYS->a3);
+				break;
+
+			case DEVSTATS:
+				deviceStats((devstat_t *) oldSYS->a2, (BOOL) oldSYS->a3);
+				break;
+
+			case KERNELTIME:
+				kernelTime((ktime_t *) oldSYS->a2, (BOOL) oldSYS->a3);
+				break;
+
+			case LOADAVG:
+				loadAverage((loadavg_t *) oldSYS->a2);
+				break;
+
+			case KLOGREAD:
+				readKlog((char *) oldSYS->a2, (int) oldSYS->a3, (int *) oldSYS->a4);
+				break;
 		}
 	}
 	
@@ -232,12 +411,14 @@ void SYSCallHandler(){
 
 	oldPGM->CP15_Cause = RI; 		// setting CP15.Cause in the PgmTrap Old Area to RI,
 
-	PGMTrapHandler(); 				// and calling JaeOS’s Pgm-Trap exception handler."
+	passUpOrDie(PGMTRAP, oldPGM); 	// and calling JaeOS’s Pgm-Trap exception handler."
+									// (its body: the entry is already timed as KPPGM)
 	}
 	
 
 /* ---- createProcess() --------------------------------------------
-* Parameters: 	Physical address of a processor state (from A2)
+* Parameters: 	Physical address of a processor state (from A2),
+*				whether to wait for a free ProcBlk (from A3)
 * Type: 		Private
 * Return:		Success/Failure state in A1
 * Description:	SYS 1
@@ -245,27 +426,97 @@ void SYSCallHandler(){
 *	It is a child of the process calling SYS 1 (g_currentProc)
 *	The child inherits the state of the parent.
 *	A1 contains the success/failure state of the operation
+*
+*	If every ProcBlk is in use:
+*		A3 FALSE: fail straight away (the original behavior)
+*		A3 TRUE: block on g_pcbSemaphore, FIFO, until admitCreators()
+*			hands us a freed ProcBlk. At most MAXCREATEWAIT creators
+*			wait at once, anyone past that fails straight away.
 * -------------------------------------- end createProcess() ---- */
-HIDDEN void createProcess(state_t *parentState){
+HIDDEN void createProcess(state_t *parentState, BOOL waitForPcb){
 	pcb_PTR newPcb = allocPcb(); // Get a pcb ready for the new process
 	
 	if(newPcb != NULL){ // make sure we actually got something
-		copyState(parentState, &(newPcb->p_s)); // inherit parent's state
-		
-		insertChild(g_currentProc, newPcb); // new proc is child of current proc (the parent)
-		insertProcQ(&(g_readyQueue), newPcb); // and now it's on the g_readyQueue
-		g_procCount++; 					// hooray, new process!
+		spawnChild(g_currentProc, newPcb, parentState);
 
-		parentState->a1 = SUCCESS; 	// Success Flag
+		g_currentProc->p_s.a1 = SUCCESS; 	// Success Flag
 	}
 	
+	else if(waitForPcb && (g_pcbSemaphore > -MAXCREATEWAIT)){ // room in the admission queue
+		// P operation on the free ProcBlks - we know there are none
+		g_pcbSemaphore--;
+
+		updateTime(); // Update the time used by this process
+		markBlocked(g_currentProc, BLOCKSEM);
+
+		insertBlocked(&g_pcbSemaphore, g_currentProc); // wait our turn
+
+		g_currentProc = NULL; // done with the current process
+		scheduler(); // so we need someone else
+	}
+
 	else{ // if we didn't get a pcb, we failed!
-		parentState->a1 = FAILURE; 	// Failure Flage
+		g_currentProc->p_s.a1 = FAILURE; 	// Failure Flage
 	}
 				
 	loadState(); // go back to where we left off
 }
 
+/* ---- spawnChild() --------------------------------------------
+* Parameters: 	pcb_PTR parent, pcb_PTR newPcb, state_t *childState
+* Type: 		Private
+* Return:		None
+* Description:
+*	Everything SYS 1 does once it has a ProcBlk: load the state,
+*	link the child to its parent and group, and make it ready.
+*	The child shares its parent's SUSPENDGROUP state, so a creator
+*	admitted while its group is suspended gets a parked child.
+* -------------------------------------- end spawnChild() ---- */
+HIDDEN void spawnChild(pcb_PTR parent, pcb_PTR newPcb, state_t *childState){
+	copyState(childState, &(newPcb->p_s)); // inherit parent's state
+		
+	insertChild(parent, newPcb); // new proc is child of current proc (the parent)
+	newPcb->p_grpID = parent->p_grpID; // and joins the parent's group
+	insertGroup(&(g_groupTable[newPcb->p_grpID]), newPcb);
+	newPcb->p_suspended = parent->p_suspended; // suspended with the rest of the group
+	TRACE(TR_CREATE, newPcb, parent->p_pid);
+	makeReady(newPcb); // ready (or parked) from birth
+	g_procCount++; 					// hooray, new process!
+}
+
+/* ---- admitCreators() --------------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called once a kill has finished freeing ProcBlks. Hands them to
+*	the creators blocked in SYS 1 in the order they arrived, finishing
+*	their SYS 1 for them (the state they passed is still in their A2).
+*	Not done from inside depthFirstMurder() so that a ProcBlk is never
+*	given to a process that is about to die in the same kill.
+* -------------------------------------- end admitCreators() ---- */
+void admitCreators(){
+	pcb_PTR waitingCreator = headBlocked(&g_pcbSemaphore);
+
+	while(waitingCreator != NULL){
+		pcb_PTR newPcb = allocPcb();
+		if(newPcb == NULL){
+			return; // still full, keep waiting
+		}
+
+		// V operation on the free ProcBlks
+		g_pcbSemaphore++;
+		removeBlocked(&g_pcbSemaphore);
+		waitingCreator->p_semAdd = NULL;
+
+		spawnChild(waitingCreator, newPcb, (state_t *) waitingCreator->p_s.a2);
+		waitingCreator->p_s.a1 = SUCCESS;
+		makeReady(waitingCreator);
+
+		waitingCreator = headBlocked(&g_pcbSemaphore);
+	}
+}
+
 /* ---- terminateProcess() --------------------------------------------
 * Parameters: 	None
 * Type: 		Private
@@ -278,6 +529,7 @@ HIDDEN void createProcess(state_t *parentState){
 * -------------------------------------- end terminateProcess() ---- */
 HIDDEN void terminateProcess(){
 	depthFirstMurder(g_currentProc); 	// Hooray, recursion!
+	admitCreators(); 	// the freed ProcBlks may be waited for
 	// now nothing is current process, so...
 	scheduler(); 	// BRING ME ANOTHER
 }
@@ -292,20 +544,33 @@ HIDDEN void terminateProcess(){
 *	Return to current process
 * -------------------------------------- end verhogen() ---- */
 HIDDEN void verhogen(int *semAdd){
+#ifdef SEMSTATS
+	pcb_PTR wokenProc = NULL; 	// for semStatV()
+	int blockedAt = 0;
+#endif
 	(*semAdd)++; // increment the semaphore of the one to be V'ed
 	
 	if(*semAdd <= 0){
 		
 		pcb_PTR signaledProc = removeBlocked(semAdd); // pop it off
 		if (signaledProc == NULL) { // will we always get something?
+			flightDump(FR_NOWAITER);
 			PANIC(); // not sure what we'd do if we don't...
 			// I mean, we'd probably PANIC(); even without this if statement
 		}
 		signaledProc->p_semAdd = NULL;
 		
-		insertProcQ(&(g_readyQueue), signaledProc); // put the signaled one on the readyQueue
+#ifdef SEMSTATS
+		wokenProc = signaledProc;
+		blockedAt = signaledProc->p_stamp; // makeReady() restamps it with the time it woke
+#endif
+		makeReady(signaledProc); // put the signaled one on the readyQueue
 	}
 
+#ifdef SEMSTATS
+	semStatV(semAdd, g_currentProc, wokenProc, blockedAt, (wokenProc != NULL) ? wokenProc->p_stamp : getTODLO());
+#endif
+
 	loadState(); // go back to where we left off
 }
 
@@ -318,12 +583,17 @@ HIDDEN void verhogen(int *semAdd){
 * -------------------------------------- end passeren() ---- */	
 HIDDEN void passeren(int *semAdd){
 	(*semAdd)--; // decrement the semaphore address of the one to be P'ed
+#ifdef SEMSTATS
+	semStatP(semAdd, g_currentProc, (*semAdd < 0), getTODLO());
+#endif
 									
 	if(*semAdd < 0){
 
 		updateTime(); // Update the time used by this process
+		markBlocked(g_currentProc, BLOCKSEM);
 
 		insertBlocked(semAdd, g_currentProc); // block current process
+		blockUpcall(); // let its thread library run something else
 
 		g_currentProc = NULL; // done with the current process
 		scheduler(); // so we need someone else
@@ -400,6 +670,8 @@ HIDDEN void waitClock(){
 	if(g_lotOfSemaphores[CLOCKINDEX] < 0){ // This should be true...
 		
 		updateTime(); // Update the time used by this process
+		markBlocked(g_currentProc, BLOCKCLOCK);
+		devStatIssue(CLOCKINDEX, g_endTOD);
 		
 		// Current proc blocked off and waiting on clock
 		insertBlocked(&(g_lotOfSemaphores[CLOCKINDEX]), g_currentProc); 
@@ -409,6 +681,7 @@ HIDDEN void waitClock(){
 		scheduler();
 	}
 
+	flightDump(FR_CLOCKWAIT);
 	PANIC(); // Should never NOT be able to wait for the clock (can't increment semaphore)
 }
 
@@ -423,6 +696,9 @@ HIDDEN void waitClock(){
 *	I/O device specified by A2, A3, and possibly A4.
 *	The current process is now waiting for this device
 *	and the scheduler is called.
+*	With tracing built in, disk TRACEDISK belongs to the trace
+*	exporter and waiting on it fails straight away. So does
+*	waiting on terminal KLOGTERM, which the kernel log owns.
 * -------------------------------------- end waitIO() ---- */
 HIDDEN void waitIO(int intlNO, int dnum, BOOL waitForTermRead){
 	// Get the index used to locate the sempahore address of our device
@@ -431,6 +707,18 @@ HIDDEN void waitIO(int intlNO, int dnum, BOOL waitForTermRead){
 	if((intlNO == LINENUMSEVEN) && (waitForTermRead == FALSE)){ // If its a transmitting terminal
 		semaphoreIndex = semaphoreIndex + TOTALDEVICES; // increment to this set of subdevices
 	}
+
+	if((intlNO == LINENUMSEVEN) && (dnum == KLOGTERM)){ // the kernel log's terminal
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+#ifdef KTRACE
+	if((intlNO == LINENUMTHREE) && (semaphoreIndex == TRACEDISKINDEX)){ // the trace exporter's disk
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+#endif
 	
 	// P operation stuff
 	g_lotOfSemaphores[semaphoreIndex] = g_lotOfSemaphores[semaphoreIndex] - 1; // Decrement semaphore
@@ -439,10 +727,13 @@ HIDDEN void waitIO(int intlNO, int dnum, BOOL waitForTermRead){
 	if(g_lotOfSemaphores[semaphoreIndex] < 0){
 							
 		updateTime();
+		markBlocked(g_currentProc, BLOCKIO);
+		devStatIssue(semaphoreIndex, g_endTOD);
 
 		// Current proc blocked off and waiting on that device
 		insertBlocked(&(g_lotOfSemaphores[semaphoreIndex]), g_currentProc);
 		g_softBlockCount++; // since we blocked something waiting for interrupt
+		blockUpcall(); // let its thread library run something else
 		
 		g_currentProc = NULL; // done with the current process
 		scheduler();
@@ -456,36 +747,746 @@ HIDDEN void waitIO(int intlNO, int dnum, BOOL waitForTermRead){
 }
 
 
+/* ---- setGroup() --------------------------------------------
+* Parameters: 	Group ID to join (from A2)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 10
+*	Move the current process into another process group.
+*	Children created afterwards inherit the new group.
+*	Fails if the group ID is out of range.
+* -------------------------------------- end setGroup() ---- */
+HIDDEN void setGroup(int grpID){
+	if((grpID < 0) || (grpID >= MAXGROUPS)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	outGroup(&(g_groupTable[g_currentProc->p_grpID]), g_currentProc); // leave the old group
+	g_currentProc->p_grpID = grpID;
+	insertGroup(&(g_groupTable[grpID]), g_currentProc); // and join the new one
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- suspendGroup() --------------------------------------------
+* Parameters: 	Group ID (from A2)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 11
+*	Park every member of the group until RESUMEGROUP:
+*		Ready members move from g_readyQueue to g_suspendedQueue
+*		Blocked members are flagged, makeReady() parks them on wake up
+*		If the caller is a member it is parked last and we reschedule
+*	Parking closes a ready member's ready interval; time parked is
+*	not ready time (RESUMEGROUP opens a new interval).
+* -------------------------------------- end suspendGroup() ---- */
+HIDDEN void suspendGroup(int grpID){
+	int now = getTODLO();
+
+	if((grpID < 0) || (grpID >= MAXGROUPS)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	pcb_PTR observedProcess = headGroup(g_groupTable[grpID]);
+	while(observedProcess != NULL){
+		if(!observedProcess->p_suspended){
+			observedProcess->p_suspended = TRUE;
+
+			// Only ready (not running, not blocked, not throttled) members have to move now
+			// (a throttled one is parked by makeReady() when replenished)
+			if((observedProcess != g_currentProc) && (observedProcess->p_semAdd == NULL) && (!observedProcess->p_throttled)){
+				outProcQ(&(g_readyQueue), observedProcess);
+				observedProcess->p_readyTime = observedProcess->p_readyTime + (now - observedProcess->p_stamp);
+				observedProcess->p_stamp = now;
+				insertProcQ(&(g_suspendedQueue), observedProcess);
+			}
+		}
+		observedProcess = nextGroup(g_groupTable[grpID], observedProcess);
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+
+	// Case 1: We just suspended ourselves
+	if(g_currentProc->p_suspended){
+		updateTime();
+		markBlocked(g_currentProc, NOTBLOCKED); // voluntary, parked rather than ready
+		insertProcQ(&(g_suspendedQueue), g_currentProc);
+		g_currentProc = NULL;
+		scheduler();
+	}
+
+	// Case 2: Someone else's group
+	loadState();
+}
+
+/* ---- resumeGroup() --------------------------------------------
+* Parameters: 	Group ID (from A2)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 12
+*	Undo SUSPENDGROUP: parked members go back on g_readyQueue and
+*	blocked members just lose the flag, so they wake up normally.
+*	Parked members are ready from now on, not from when they parked.
+* -------------------------------------- end resumeGroup() ---- */
+HIDDEN void resumeGroup(int grpID){
+	int now = getTODLO();
+
+	if((grpID < 0) || (grpID >= MAXGROUPS)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	pcb_PTR observedProcess = headGroup(g_groupTable[grpID]);
+	while(observedProcess != NULL){
+		if(observedProcess->p_suspended){
+			observedProcess->p_suspended = FALSE;
+
+			if((observedProcess->p_semAdd == NULL) && (!observedProcess->p_throttled)){ // it was parked
+				outProcQ(&(g_suspendedQueue), observedProcess);
+				observedProcess->p_stamp = now;
+				insertProcQ(&(g_readyQueue), observedProcess);
+			}
+		}
+		observedProcess = nextGroup(g_groupTable[grpID], observedProcess);
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- signalGroup() --------------------------------------------
+* Parameters: 	Group ID (from A2), signal bits to post (from A3)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 13
+*	OR the signal bits into every member's pending mask.
+*	Members collect (and clear) them with GETSIGNALS.
+* -------------------------------------- end signalGroup() ---- */
+HIDDEN void signalGroup(int grpID, unsigned int sigMask){
+	if((grpID < 0) || (grpID >= MAXGROUPS)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	pcb_PTR observedProcess = headGroup(g_groupTable[grpID]);
+	while(observedProcess != NULL){
+		observedProcess->p_sigPending = observedProcess->p_sigPending | sigMask;
+		observedProcess = nextGroup(g_groupTable[grpID], observedProcess);
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- terminateGroup() --------------------------------------------
+* Parameters: 	Group ID (from A2)
+* Type: 		Private
+* Return:		Success/Failure state in A1 (if the caller survives)
+* Description:	SYS 14
+*	SYS 2 every member of the group (and so their offspring).
+*	depthFirstMurder() takes each victim off the group list, so we
+*	just keep killing the head until the group is empty.
+*	If the caller was a member, get a new job.
+* -------------------------------------- end terminateGroup() ---- */
+HIDDEN void terminateGroup(int grpID){
+	if((grpID < 0) || (grpID >= MAXGROUPS)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	while(g_groupTable[grpID] != NULL){
+		depthFirstMurder(headGroup(g_groupTable[grpID]));
+	}
+	admitCreators(); // the freed ProcBlks may be waited for
+
+	// Case 1: We killed ourselves
+	if(g_currentProc == NULL){
+		scheduler();
+	}
+
+	// Case 2: Someone else's group
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- getSignals() --------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		Pending signal bits (in A1)
+* Description:	SYS 15
+*	Return the signals posted to the current process by SIGNALGROUP
+*	and clear them.
+* -------------------------------------- end getSignals() ---- */
+HIDDEN void getSignals(){
+	g_currentProc->p_s.a1 = g_currentProc->p_sigPending;
+	g_currentProc->p_sigPending = 0;
+	loadState();
+}
+
+
+/* ---- yield() --------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 16
+*	Give up the rest of the quantum: go to the back of the
+*	g_readyQueue (still ready) and let the scheduler pick someone.
+* -------------------------------------- end yield() ---- */
+HIDDEN void yield(){
+	g_currentProc->p_s.a1 = SUCCESS;
+
+	updateTime();
+	markBlocked(g_currentProc, NOTBLOCKED); // voluntary, but still ready
+	insertProcQ(&(g_readyQueue), g_currentProc); // same as an end of quantum
+	g_currentProc = NULL;
+	scheduler();
+}
+
+/* ---- yieldTo() --------------------------------------------
+* Parameters: 	PID of the process to run next (from A2)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 17
+*	Switch straight to the named process, skipping the scheduler.
+*	The caller goes to the back of the g_readyQueue and the target
+*	runs on whatever is left of the caller's quantum (the timer is
+*	not touched), so a pipeline of processes handing off to each
+*	other costs one trap per hand off instead of a V and a P.
+*	Fails (and the caller keeps running) if the target is not ready.
+* -------------------------------------- end yieldTo() ---- */
+HIDDEN void yieldTo(int pid){
+	pcb_PTR target = findPcb(pid);
+
+	// Only a ready process can be switched to: not us, not blocked, not parked
+	if((target == NULL) || (target == g_currentProc) || (target->p_semAdd != NULL) || (target->p_suspended)
+			|| (target->p_throttled) || (g_budgetsInUse && (overBudget(target) != NULL))){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	outProcQ(&(g_readyQueue), target); // jump the queue
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	updateTime(); // charge the caller, the target is charged from here on
+	markBlocked(g_currentProc, NOTBLOCKED); // voluntary, but still ready
+	insertProcQ(&(g_readyQueue), g_currentProc);
+
+	g_currentProc = target;
+	target->p_dispatches++; // the scheduler never sees this dispatch
+	target->p_readyTime = target->p_readyTime + (g_endTOD - target->p_stamp);
+	latencyDispatched(target, g_endTOD);
+	TRACE(TR_DISPATCH, target, 0);
+	loadState(); // donate the remaining quantum
+}
+
+/* ---- getPid() --------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		PID of the current process (in A1)
+* Description:	SYS 18
+*	So processes can tell each other who to YIELDTO.
+* -------------------------------------- end getPid() ---- */
+HIDDEN void getPid(){
+	g_currentProc->p_s.a1 = g_currentProc->p_pid;
+	loadState();
+}
+
+
+/* ---- specUpcall() --------------------------------------------
+* Parameters: 	Physical address of a processor state (from A2)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 19
+*	Works like a SYS 5 vector for blocking: from now on, whenever
+*	this process blocks in a P (SYS 4) or a SYS 8, a new activation
+*	is started from this state (see blockUpcall()), as long as fewer
+*	than MAXACTIVATIONS processes of its group share the state.
+*	Passing NULL turns the upcall back off.
+*	Unlike SYS 5 it may be called any number of times.
+* -------------------------------------- end specUpcall() ---- */
+HIDDEN void specUpcall(state_t *upcallState){
+	g_currentProc->p_upcall = upcallState;
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- blockUpcall() --------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		None (the caller goes on to the scheduler)
+* Description:
+*	Called right after the current process was put on the ASL.
+*	If it asked for an upcall, start a new activation: a fresh
+*	process (in the same group, with the same upcall) loaded with the
+*	upcall state, and the blocked process' PID in A1.
+*	The blocked process stays blocked, so the semaphore stays correct;
+*	the activation is a sibling rather than a child so it can
+*	SYS 2 itself once it runs out of work without killing anyone.
+*	The process simply blocks as usual, without an activation, if:
+*		creators are waiting in SYS 1: freed ProcBlks are theirs first
+*		MAXACTIVATIONS members of its group already share its upcall
+*		no ProcBlk is free
+* -------------------------------------- end blockUpcall() ---- */
+HIDDEN void blockUpcall(){
+	if((g_currentProc->p_upcall == NULL) || (g_pcbSemaphore < 0)){
+		return;
+	}
+
+	int sharing = 0;
+	pcb_PTR observedProcess = headGroup(g_groupTable[g_currentProc->p_grpID]);
+	while(observedProcess != NULL){
+		if(observedProcess->p_upcall == g_currentProc->p_upcall){
+			sharing++;
+		}
+		observedProcess = nextGroup(g_groupTable[g_currentProc->p_grpID], observedProcess);
+	}
+	if(sharing >= MAXACTIVATIONS){
+		return;
+	}
+
+	pcb_PTR activation = allocPcb();
+	if(activation == NULL){
+		return;
+	}
+
+	copyState(g_currentProc->p_upcall, &(activation->p_s));
+	activation->p_s.a1 = g_currentProc->p_pid; // who blocked
+	activation->p_upcall = g_currentProc->p_upcall;
+
+	if(g_currentProc->p_prnt != NULL){
+		insertChild(g_currentProc->p_prnt, activation);
+	}
+	else{
+		insertChild(g_currentProc, activation); // the root has no siblings
+	}
+	activation->p_grpID = g_currentProc->p_grpID;
+	insertGroup(&(g_groupTable[activation->p_grpID]), activation);
+
+	activation->p_stamp = g_endTOD; // the blocker just called updateTime()
+	TRACE(TR_CREATE, activation, g_currentProc->p_pid);
+	insertProcQ(&(g_readyQueue), activation);
+	g_procCount++;
+}
+
+
+/* ---- setBudget() --------------------------------------------
+* Parameters: 	PID (from A2, 0 for the caller),
+*				microseconds per budget period (from A3, 0 removes it),
+*				BUDGETSUBTREE and/or BUDGETKILL (from A4)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 20
+*	Give a process a CPU budget per BUDGETPERIOD intervals.
+*	With BUDGETSUBTREE its descendants are charged to it as well.
+*	Running out parks the process(es) until the next period,
+*	or with BUDGETKILL terminates the budget holder's subtree.
+*	A process may only budget itself and its descendants, and
+*	flags other than the two above are refused.
+* -------------------------------------- end setBudget() ---- */
+HIDDEN void setBudget(int pid, int budget, int flags){
+	pcb_PTR target = g_currentProc;
+	if(pid != 0){
+		target = findPcb(pid);
+	}
+
+	if((target == NULL) || (budget < 0) || ((flags & ~(BUDGETSUBTREE | BUDGETKILL)) != 0)){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	pcb_PTR observedProcess = target;
+	while((observedProcess != NULL) && (observedProcess != g_currentProc)){ // up to us, or off the top
+		observedProcess = observedProcess->p_prnt;
+	}
+	if(observedProcess == NULL){ // not ours to budget
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	target->p_budget = budget;
+	target->p_budgetFlags = flags;
+	target->p_budgetEpoch = g_budgetEpoch; // starts with a full period
+	target->p_budgetUsed = 0;
+
+	if(budget > 0){
+		g_budgetsInUse = TRUE; // from now on updateTime() charges budgets
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- getBudget() --------------------------------------------
+* Parameters: 	PID (from A2, 0 for the caller),
+*				Physical address of a budget_t to fill in (from A3)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 21
+*	Report a process' budget, how much of it is used this period
+*	and how many times it has run out.
+* -------------------------------------- end getBudget() ---- */
+HIDDEN void getBudget(int pid, budget_t *report){
+	pcb_PTR target = g_currentProc;
+	if(pid != 0){
+		target = findPcb(pid);
+	}
+
+	if(target == NULL){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	updateTime(); // so our own usage is up to date
+
+	report->b_budget = target->p_budget;
+	report->b_used = 0;
+	if(target->p_budgetEpoch == g_budgetEpoch){
+		report->b_used = target->p_budgetUsed;
+	}
+	report->b_flags = target->p_budgetFlags;
+	report->b_throttles = target->p_throttles;
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- getTimes() --------------------------------------------
+* Parameters: 	Physical address of a cputime_t to fill in (from A2)
+* Type: 		Private
+* Return:		None
+* Description:	SYS 22
+*	Like SYS 6, but also reports the CPU time of every descendant
+*	that has terminated so far (rolled up by depthFirstMurder()).
+*	A process is charged for time spent in this function.
+* -------------------------------------- end getTimes() ---- */
+HIDDEN void getTimes(cputime_t *report){
+	updateTime(); // Update the time used by this processor since start
+
+	report->c_self = g_currentProc->p_time;
+	report->c_children = g_currentProc->p_childTime;
+
+	loadState();
+}
+
+
+/* ---- snapshot() --------------------------------------------
+* Parameters: 	Physical address of a procsnap_t array (from A2),
+*				how many records it can hold (from A3)
+* Type: 		Private
+* Return:		Number of records written in A1
+* Description:	SYS 23
+*	Copy out a record for every live process (up to maxRecords of
+*	them) in one trap, so the system can be watched from inside.
+*	The ProcBlk table is walked slot by slot rather than through
+*	the tree or the queues, so a snapshot always costs O(MAXPROC)
+*	and never follows a pointer that might be mid-update.
+*	Records come out in slot order, not PID or tree order.
+* -------------------------------------- end snapshot() ---- */
+HIDDEN void snapshot(procsnap_t *buffer, int maxRecords){
+	int slot;
+	int written = 0;
+	pcb_PTR observedProcess;
+
+	updateTime(); // so the caller's own ps_time is current
+
+	for(slot = 0; (slot < MAXPROC) && (written < maxRecords); slot++){
+		observedProcess = pcbSlot(slot);
+		if(observedProcess == NULL){
+			continue; // free ProcBlk
+		}
+
+		buffer[written].ps_pid = observedProcess->p_pid;
+		buffer[written].ps_ppid = 0;
+		if(observedProcess->p_prnt != NULL){
+			buffer[written].ps_ppid = observedProcess->p_prnt->p_pid;
+		}
+		buffer[written].ps_semAdd = observedProcess->p_semAdd;
+		buffer[written].ps_device = NODEVICE;
+		buffer[written].ps_time = observedProcess->p_time;
+		buffer[written].ps_dispatches = observedProcess->p_dispatches;
+		buffer[written].ps_grpID = observedProcess->p_grpID;
+
+		// Same order of cases as depthFirstMurder()
+		if(observedProcess == g_currentProc){
+			buffer[written].ps_state = PSRUNNING;
+		}
+		else if(observedProcess->p_semAdd != NULL){
+			buffer[written].ps_state = PSBLOCKED;
+			if((observedProcess->p_semAdd >= &(g_lotOfSemaphores[0])) && (observedProcess->p_semAdd <= &(g_lotOfSemaphores[LASTSEMINDEX]))){
+				buffer[written].ps_device = observedProcess->p_semAdd - &(g_lotOfSemaphores[0]);
+			}
+		}
+		else if(observedProcess->p_throttled){
+			buffer[written].ps_state = PSTHROTTLED;
+		}
+		else if(observedProcess->p_suspended){
+			buffer[written].ps_state = PSSUSPENDED;
+		}
+		else{
+			buffer[written].ps_state = PSREADY;
+		}
+
+		written++;
+	}
+
+	g_currentProc->p_s.a1 = written;
+	loadState();
+}
+
+
+/* ---- getSchedStats() --------------------------------------------
+* Parameters: 	PID (from A2, 0 for the caller),
+*				Physical address of a schedstat_t to fill in (from A3)
+* Type: 		Private
+* Return:		Success/Failure state in A1
+* Description:	SYS 24
+*	Report how a process has been scheduled: how often it ran, how
+*	often it gave up the CPU versus was preempted, how long it sat
+*	ready, and how long it was blocked on semaphores, I/O and the
+*	clock. Intervals still open (it is ready or blocked right now)
+*	are not included until they close.
+* -------------------------------------- end getSchedStats() ---- */
+HIDDEN void getSchedStats(int pid, schedstat_t *report){
+	int i;
+	pcb_PTR target = g_currentProc;
+	if(pid != 0){
+		target = findPcb(pid);
+	}
+
+	if(target == NULL){
+		g_currentProc->p_s.a1 = FAILURE;
+		loadState();
+	}
+
+	report->s_dispatches = target->p_dispatches;
+	report->s_volSwitches = target->p_volSwitches;
+	report->s_involSwitches = target->p_involSwitches;
+	report->s_readyTime = target->p_readyTime;
+	for(i = 0; i < BLOCKCATS; i++){
+		report->s_blockedTime[i] = target->p_blockedTime[i];
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- readTrace() --------------------------------------------
+* Parameters: 	Physical address of a traceev_t array (from A2),
+*				how many events it can hold (from A3)
+* Type: 		Private
+* Return:		Number of events copied in A1
+* Description:	SYS 25
+*	Drain the kernel trace ring in bulk, oldest event first.
+*	Always returns 0 unless the nucleus was built with -DKTRACE.
+* -------------------------------------- end readTrace() ---- */
+HIDDEN void readTrace(traceev_t *buffer, int maxEvents){
+	g_currentProc->p_s.a1 = traceRead(buffer, maxEvents);
+	loadState();
+}
+
+
+/* ---- startProfile() --------------------------------------------
+* Parameters: 	PID to sample (from A2, 0 for every process),
+*				sampling period (from A3, 0 for once per quantum)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 26
+*	Throw away any old profile and start sampling PCs.
+*	The caller's own slice is rearmed so a short period
+*	takes effect straight away.
+* -------------------------------------- end startProfile() ---- */
+HIDDEN void startProfile(int pid, int period){
+	profStart(pid, period);
+
+	if(g_profPeriod > 0){
+		int timeLeft = g_endOfQuantum - getTODLO();
+		if(timeLeft > g_profPeriod){
+			setTIMER(g_profPeriod);
+		}
+	}
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+/* ---- stopProfile() --------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		Samples taken in A1
+* Description:	SYS 27
+*	Stop sampling; the profile stays readable with SYS 28.
+* -------------------------------------- end stopProfile() ---- */
+HIDDEN void stopProfile(){
+	g_currentProc->p_s.a1 = profStop();
+	loadState();
+}
+
+/* ---- readProfile() --------------------------------------------
+* Parameters: 	Physical address of a profent_t array (from A2),
+*				how many entries it can hold (from A3)
+* Type: 		Private
+* Return:		Number of entries copied in A1
+* Description:	SYS 28
+*	Copy out the (PID, PC, count) histogram.
+* -------------------------------------- end readProfile() ---- */
+HIDDEN void readProfile(profent_t *buffer, int maxEntries){
+	g_currentProc->p_s.a1 = profRead(buffer, maxEntries);
+	loadState();
+}
+
+
+/* ---- readLatency() --------------------------------------------
+* Parameters: 	Physical address of a lathist_t to fill in (from A2),
+*				whether to clear the histograms afterwards (from A3)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 29
+*	Copy out the interrupt -> wake and wake -> dispatch
+*	histograms of every device class and the pseudo-clock.
+* -------------------------------------- end readLatency() ---- */
+HIDDEN void readLatency(lathist_t *report, BOOL reset){
+	latencyRead(report, reset);
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- semTop() --------------------------------------------
+* Parameters: 	Physical address of a semstat_t array (from A2),
+*				how many entries it can hold (from A3)
+* Type: 		Private
+* Return:		Number of entries written in A1
+* Description:	SYS 30
+*	Report the semaphores processes spent the longest blocked on,
+*	worst first, with their P, contention and hold statistics.
+*	Always returns 0 unless the nucleus was built with -DSEMSTATS.
+* -------------------------------------- end semTop() ---- */
+HIDDEN void semTop(semstat_t *buffer, int n){
+	g_currentProc->p_s.a1 = 0;
+#ifdef SEMSTATS
+	g_currentProc->p_s.a1 = semStatTop(buffer, n);
+#endif
+	loadState();
+}
+
+
+/* ---- deviceStats() --------------------------------------------
+* Parameters: 	Physical address of MAXSEMA4 devstat_t's (from A2),
+*				whether to clear the counters afterwards (from A3)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 31
+*	Copy out operations, errors, busy and idle time and queue
+*	depth for every device, indexed like the device semaphores.
+* -------------------------------------- end deviceStats() ---- */
+HIDDEN void deviceStats(devstat_t *report, BOOL reset){
+	devStatRead(report, reset, getTODLO());
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- kernelTime() --------------------------------------------
+* Parameters: 	Physical address of a ktime_t to fill in (from A2),
+*				whether to clear the totals afterwards (from A3)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 32
+*	Report time and entry counts for every kernel path, idle
+*	time, and the share of the total left for processes.
+* -------------------------------------- end kernelTime() ---- */
+HIDDEN void kernelTime(ktime_t *report, BOOL reset){
+	kernelTimeRead(report, reset);
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- loadAverage() --------------------------------------------
+* Parameters: 	Physical address of a loadavg_t to fill in (from A2)
+* Type: 		Private
+* Return:		SUCCESS in A1
+* Description:	SYS 33
+*	Report the 1, 5 and 15 interval load averages and how idle
+*	the last interval was.
+* -------------------------------------- end loadAverage() ---- */
+HIDDEN void loadAverage(loadavg_t *report){
+	loadRead(report);
+
+	g_currentProc->p_s.a1 = SUCCESS;
+	loadState();
+}
+
+
+/* ---- readKlog() --------------------------------------------
+* Parameters: 	Physical address of a buffer (from A2),
+*				its size in bytes (from A3),
+*				where to put the dropped message count, or NULL (from A4)
+* Type: 		Private
+* Return:		Bytes copied in A1
+* Description:	SYS 34
+*	Copy out kernel log text this caller has not read yet.
+* -------------------------------------- end readKlog() ---- */
+HIDDEN void readKlog(char *buffer, int maxBytes, int *dropped){
+	g_currentProc->p_s.a1 = klogRead(buffer, maxBytes, dropped);
+	loadState();
+}
+
+
 /* ---- depthFirstMurder() --------------------------------------------
 * Parameters: 	pcb_PTR observedProcess
-* Type: 		Private
-* Return:		None (but scheduler should be called afterwards)
+* Type: 		Public
+* Return:		CPU time of the whole subtree (but scheduler should be called afterwards)
 * Description:
 *	Kill a process, it's children, and so on. 	
+*	On the way back up each process' p_time plus its children's time
+*	is folded into its parent's p_childTime, so whoever survives the
+*	kill keeps the CPU time of all of its dead descendants.
 *	Has cases for if the process killed was:
 *		1: the current process
-*		2: on the ready queue
+*		2: on the ready (or suspended, or throttled) queue
 *		3: blocked by a semaphore
+*	Either way it leaves its parent and its group.
 *	This will usually be called on currentProc (since it can only be accessed
 *	by a SYS mode-priveleged call), but it is not hardcoded and accounts
 *	for the currentProc scenario in a modular fashion.
 * -------------------------------------- end depthFirstMurder() ---- */
-HIDDEN void depthFirstMurder(pcb_PTR observedProcess){	
+int depthFirstMurder(pcb_PTR observedProcess){	
+	int subtreeTime;
+
 	while(!emptyChild(observedProcess)){ // Depth-first search for the "bottom" child
-		depthFirstMurder(removeChild(observedProcess)); // Kill each child before their parent
+		// Kill each child before their parent, keeping the time they used
+		observedProcess->p_childTime = observedProcess->p_childTime + depthFirstMurder(removeChild(observedProcess));
 	}
 	
 	// We've reached this point once we've killed all of observedProcess's children (or observedProcess never had children)
 
 	// Case 1: observedProcess is current process
 	if (g_currentProc == observedProcess){
-		outChild(observedProcess); // no longer anyone's child
+		updateTime(); // charge the last bit of its final quantum
 		g_currentProc = NULL;
 	}
 	
-	// Case 2: observedProcess is on the readyQueue
+	// Case 2: observedProcess is on the readyQueue (or parked off it)
 	else if(observedProcess->p_semAdd == NULL){
-		outProcQ(&(g_readyQueue), observedProcess); // Taken off readyQueue since you're dead
+		if(observedProcess->p_throttled){
+			outProcQ(&(g_throttledQueue), observedProcess);
+		}
+		else if(observedProcess->p_suspended){
+			outProcQ(&(g_suspendedQueue), observedProcess);
+		}
+		else{
+			outProcQ(&(g_readyQueue), observedProcess); // Taken off readyQueue since you're dead
+		}
 	}
 	
 	// Case 3: observedProcess is on the ASL
@@ -502,8 +1503,21 @@ HIDDEN void depthFirstMurder(pcb_PTR observedProcess){
 		}
 	}
 	
+	subtreeTime = observedProcess->p_time + observedProcess->p_childTime;
+
+	// Only the root of the kill still has a parent, the rest were removeChild()'ed
+	if(observedProcess->p_prnt != NULL){
+		observedProcess->p_prnt->p_childTime = observedProcess->p_prnt->p_childTime + subtreeTime;
+	}
+
+	outChild(observedProcess); // no longer anyone's child (TERMINATEGROUP may hit a non-root)
+	outGroup(&(g_groupTable[observedProcess->p_grpID]), observedProcess); // nor a group member
+
+	TRACE(TR_TERMINATE, observedProcess, 0);
 	freePcb(observedProcess); // Finally, we can kill this node for good
 	g_procCount--; // Which means one less process!
+
+	return subtreeTime;
 }
 
 /* ---- passUpOrDie() --------------------------------------------
@@ -527,6 +1541,7 @@ HIDDEN void depthFirstMurder(pcb_PTR observedProcess){
 HIDDEN void passUpOrDie(int trapType, state_t *oldState){
 	// Case 1: SYS 5 had not been called
 	if(g_currentProc->stateArray[trapType].newState == NULL) { 
+		klogHex(KL_WARN, "no trap handler, killing pid ", g_currentProc->p_pid);
 		terminateProcess();
 	} 
 
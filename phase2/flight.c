@@ -0,0 +1,266 @@
+/**************************************************************
+* FILENAME:		flight.c
+*
+* DESCRIPTION:	Flight Recorder Module for JaeOS
+*
+* NOTES:		Keeps the last FLIGHTTICKS values of g_softBlockCount,
+*				one per pseudo-clock tick, and, built with -DKFLIGHT
+*				(make FLIGHTFLAGS=-DKFLIGHT), the last FLIGHTSIZE
+*				tracepoint events (dispatches, preemptions, SYS calls,
+*				blocks, wake ups, ...). Events cost a call and a TOD
+*				read per tracepoint, so the default build leaves them
+*				out; its dump still has the queues and the ASL.
+*
+*				Before the nucleus PANICs it calls flightDump(), which
+*				writes the events, the history, the ready, throttled
+*				and suspended queues and every process on the ASL to terminal
+*				FLIGHTTERM. Interrupts are off by then, so each
+*				character is polled out. The format is lines of hex
+*				words, one record per line:
+*
+*					FLT reason tod currentPid procCount softBlockCount
+*					E tod type pid arg			(oldest first, -DKFLIGHT only)
+*					S count count ...			(oldest first)
+*					R pid pid ...				(ready queue, head first)
+*					T pid pid ...				(throttled queue)
+*					P pid pid ...				(parked by SUSPENDGROUP)
+*					B pid semAdd semValue		(one per blocked process)
+*					END
+*
+*				tools/flightdec turns the terminal log back into
+*				something readable.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/pcb.e"
+#include "../e/initial.e"
+#include "../e/flight.e"
+#include "uarm/libuarm.h"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+#ifdef KFLIGHT
+HIDDEN traceev_t flightRing[FLIGHTSIZE];
+HIDDEN unsigned int flightHead;		// events ever recorded
+#endif
+
+HIDDEN int softHistory[FLIGHTTICKS];
+HIDDEN unsigned int softHead;		// samples ever taken
+
+HIDDEN BOOL termDead;				// FLIGHTTERM stopped answering, stop writing
+
+#define FLIGHTTERMREG		((termreg_t *) (DEVBASEADDRESS + ((((LINENUMSEVEN - DEVICEOFFSET) * TOTALDEVICES) + FLIGHTTERM) * DEVWORDLENGTH)))
+#define PRINTCHR			2
+#define BYTELEN				8
+#define HEXDIGITS			8
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void flightEvent(int type, pcb_PTR proc, unsigned int arg);	(-DKFLIGHT)
+//	   void flightTick();
+//	   void flightDump(int reason);
+/********************* Private Functions *********************/
+HIDDEN void dumpQueue (char tag, pcb_PTR tp);
+HIDDEN void putHex (unsigned int n);
+HIDDEN void putStr (char *s);
+HIDDEN void putChar (char c);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- flightEvent() ---------------------------------------
+* Parameters: 	int type, pcb_PTR proc (may be NULL), unsigned int arg
+* Type: 		Public
+* Return:		None
+* Description:
+*	Record one event, overwriting the oldest.
+* --------------------------------- end flightEvent() ---- */
+#ifdef KFLIGHT
+void flightEvent(int type, pcb_PTR proc, unsigned int arg){
+	traceev_t *event = &(flightRing[flightHead & (FLIGHTSIZE - 1)]);
+
+	event->t_tod = getTODLO();
+	event->t_type = type;
+	event->t_pid = 0;
+	if(proc != NULL){
+		event->t_pid = proc->p_pid;
+	}
+	event->t_arg = arg;
+
+	flightHead++;
+}
+#endif
+
+/* ---- flightTick() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called every pseudo-clock tick: remember g_softBlockCount.
+* --------------------------------- end flightTick() ---- */
+void flightTick(){
+	softHistory[softHead % FLIGHTTICKS] = g_softBlockCount;
+	softHead++;
+}
+
+/* ---- flightDump() ---------------------------------------
+* Parameters: 	int reason (FR_DEADLOCK, FR_NOLINE, ...)
+* Type: 		Public
+* Return:		None (the caller PANICs next)
+* Description:
+*	Write everything the recorder knows, and a snapshot of the
+*	queues and the ASL, to terminal FLIGHTTERM.
+* --------------------------------- end flightDump() ---- */
+void flightDump(int reason){
+	unsigned int i, first;
+	int slot;
+	pcb_PTR p;
+
+	putStr("FLT ");
+	putHex(reason);
+	putChar(' ');
+	putHex(getTODLO());
+	putChar(' ');
+	putHex((g_currentProc != NULL) ? g_currentProc->p_pid : 0);
+	putChar(' ');
+	putHex(g_procCount);
+	putChar(' ');
+	putHex(g_softBlockCount);
+	putChar('\n');
+
+#ifdef KFLIGHT
+	first = (flightHead > FLIGHTSIZE) ? (flightHead - FLIGHTSIZE) : 0;
+	for(i = first; i < flightHead; i++){
+		traceev_t *event = &(flightRing[i & (FLIGHTSIZE - 1)]);
+
+		putStr("E ");
+		putHex(event->t_tod);
+		putChar(' ');
+		putHex(event->t_type);
+		putChar(' ');
+		putHex(event->t_pid);
+		putChar(' ');
+		putHex(event->t_arg);
+		putChar('\n');
+	}
+#endif
+
+	putChar('S');
+	first = (softHead > FLIGHTTICKS) ? (softHead - FLIGHTTICKS) : 0;
+	for(i = first; i < softHead; i++){
+		putChar(' ');
+		putHex(softHistory[i % FLIGHTTICKS]);
+	}
+	putChar('\n');
+
+	dumpQueue('R', g_readyQueue);
+	dumpQueue('T', g_throttledQueue);
+	dumpQueue('P', g_suspendedQueue);
+
+	// The ASL, one line per process blocked on it
+	for(slot = 0; slot < MAXPROC; slot++){
+		p = pcbSlot(slot);
+		if((p != NULL) && (p->p_semAdd != NULL)){
+			putStr("B ");
+			putHex(p->p_pid);
+			putChar(' ');
+			putHex((unsigned int) p->p_semAdd);
+			putChar(' ');
+			putHex(*(p->p_semAdd));
+			putChar('\n');
+		}
+	}
+
+	putStr("END\n");
+}
+
+/* ---- dumpQueue() ---------------------------------------
+* Parameters: 	char tag, pcb_PTR tp
+* Type: 		Private
+* Return:		None
+* Description:
+*	One line: tag, then the PID of everyone on the queue
+*	whose tail is tp, head first.
+* --------------------------------- end dumpQueue() ---- */
+HIDDEN void dumpQueue(char tag, pcb_PTR tp){
+	pcb_PTR p = headProcQ(tp);
+
+	putChar(tag);
+	while(p != NULL){
+		putChar(' ');
+		putHex(p->p_pid);
+		p = (p == tp) ? NULL : p->p_next;
+	}
+	putChar('\n');
+}
+
+/* ---- putHex() ---------------------------------------
+* Parameters: 	unsigned int n
+* Type: 		Private
+* Return:		None
+* Description:
+*	Write n in hex, without leading zeros or a prefix.
+* --------------------------------- end putHex() ---- */
+HIDDEN void putHex(unsigned int n){
+	char buf[HEXDIGITS + 1];
+	int i = HEXDIGITS;
+
+	buf[i] = '\0';
+	do {
+		buf[--i] = "0123456789abcdef"[n & 0xF];
+		n = n >> 4;
+	} while(n != 0);
+	putStr(&buf[i]);
+}
+
+/* ---- putStr() ---------------------------------------
+* Parameters: 	char *s
+* Type: 		Private
+* Return:		None
+* Description:
+*	Write a NUL terminated string.
+* --------------------------------- end putStr() ---- */
+HIDDEN void putStr(char *s){
+	while(*s != '\0'){
+		putChar(*s);
+		s++;
+	}
+}
+
+/* ---- putChar() ---------------------------------------
+* Parameters: 	char c
+* Type: 		Private
+* Return:		None
+* Description:
+*	Transmit one character on FLIGHTTERM and spin until it is
+*	done (interrupts are off in the nucleus). If the terminal
+*	is missing or fails, give up on the rest of the dump
+*	rather than spin forever.
+* --------------------------------- end putChar() ---- */
+HIDDEN void putChar(char c){
+	termreg_t *term = FLIGHTTERMREG;
+	unsigned int status;
+
+	if(termDead){
+		return;
+	}
+
+	// a process may have left a character in flight
+	while((term->transm_status & DEVSTATUSMASK) == DEVICEBUSY){
+	}
+
+	term->transm_command = PRINTCHR | (((unsigned int) c) << BYTELEN);
+	do {
+		status = term->transm_status;
+	} while((status & DEVSTATUSMASK) == DEVICEBUSY);
+
+	if((status & DEVSTATUSMASK) != CHARDONE){
+		termDead = TRUE;
+		return;
+	}
+	term->transm_command = ACK;
+}
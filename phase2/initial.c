@@ -37,14 +37,16 @@
 
 #include "../e/pcb.e"
 #include "../e/asl.e"
+#include "../e/record.e"
 #include "../e/initial.e"
 #include "../e/scheduler.e"
 #include "../e/exceptions.e"
 #include "../e/interrupts.e"
+#include "../e/klog.e"
 
 #include "../h/const.h"
 #include "../h/types.h"
-#include "/usr/include/uarm/libuarm.h"
+#include "uarm/libuarm.h"
 
 ///////////////////////// GLOBAL DEFINITONS //////////////////////////
 
@@ -59,12 +61,26 @@ int 			g_endOfInterval;		// When the interval timer will run dry (calculated "da
 
 pcb_PTR 		g_currentProc;			// holds the current state that is actually running
 pcb_PTR 		g_readyQueue;			// tp->ProcBlk of processes: ready AND waiting for turn of execution
+pcb_PTR 		g_suspendedQueue;		// tp->ProcBlk of processes: ready BUT parked by SUSPENDGROUP
+pcb_PTR 		g_throttledQueue;		// tp->ProcBlk of processes: ready BUT out of CPU budget
+
+BOOL 			g_budgetsInUse;			// has anyone ever set a CPU budget?
+int 			g_budgetEpoch;			// bumped every replenishment, stale p_budgetUsed is 0
+int 			g_budgetTicks;			// intervals since the last replenishment
+
+pcb_PTR 		g_groupTable[MAXGROUPS];	// tp->ProcBlk of each process group's members
 
 int g_lotOfSemaphores[MAXSEMA4]; 		// array of all semaphores:
 								// 8 * (Disks, Tapes, Printers, Networking Devices), 16 Terminals, 1 Clock
 
 int g_deviceStatus[MAXSEMA4]; 			// status held for each device's semaphore
 
+int g_pcbSemaphore; 					// creators blocked in SYS 1 waiting for a free ProcBlk
+
+BOOL 			g_profiling;			// is PROFSTART sampling PCs?
+int 			g_profPeriod;			// sample this often inside a quantum, 0 = only at line 2 interrupts
+int 			g_endOfQuantum;			// when the current process' time slice ends (calculated "date")
+
 extern void test();
 
 /* ---- main() --------------------------------------------
@@ -94,12 +110,27 @@ void main(){
 	
 	g_currentProc = NULL; 				// none running yet
 	g_readyQueue = mkEmptyProcQ(); 		// get an empty queue ready
+	g_suspendedQueue = mkEmptyProcQ(); 	// no one is suspended yet
+	g_throttledQueue = mkEmptyProcQ(); 	// or throttled
+
+	g_budgetsInUse = FALSE;
+	g_budgetEpoch = 0;
+	g_budgetTicks = 0;
+
+	for (int i = 0; i < MAXGROUPS; i++){
+		g_groupTable[i] = NULL;			// and every group is empty
+	}
 
 	// Default all 49 semaphores to 0 (since they're just ints)
 	for (int i = 0; i < MAXSEMA4; i++){
 		g_lotOfSemaphores[i] = 0;
 		g_deviceStatus[i] = 0;
 	}
+	g_pcbSemaphore = 0;					// no one waiting to create yet
+
+	g_profiling = FALSE;				// no profile until PROFSTART
+	g_profPeriod = 0;
+	g_endOfQuantum = 0;
 	
 	/* //////////// Populate the four New Areas //////////// */
 	state_t *procState; 				// set up the state a process could be in
@@ -135,6 +166,7 @@ void main(){
 	initASL(); // Get ASL ready too
 	pcb_PTR firstProc = allocPcb(); // Initalize the very first process
 	insertProcQ(&(g_readyQueue), firstProc); // Insert the new process onto ready queue
+	insertGroup(&(g_groupTable[0]), firstProc); // everyone descends from group 0
 	// first job is now ready!
 	g_procCount = 1;		// we should have exactly 1 process now
 	
@@ -149,7 +181,10 @@ void main(){
 	// DO NOT CHANGE THE LOCATION OF THIS LINE OR WE ARE SCREWED
 
 	setTIMER(QUANTUM); // initialize timer with full quantum
-	
+
+	klog(KL_INFO, "JaeOS nucleus started");
+
+	firstProc->p_stamp = getTODLO(); // ready from here, not from boot
 	scheduler(); // now let scheduler do the rest of the work
 	
 	PANIC(); // better not get here!
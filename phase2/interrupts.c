@@ -6,7 +6,8 @@
 * NOTES:		Handles the highest priority interrupting line number.
 *				Line 0, 1 interrupts are unsupported
 *				Line 2 interrupts are handled based on whether it
-*					was the interval timer or end of a quantum.
+*					was the interval timer or end of a quantum
+*					(or, while profiling, just a sampling tick).
 *				Line 3-6 interrupts are handled with a V operation and ACK.
 *				Line 7 interrupts are handled the same as above,
 *					but account for the subdevices.
@@ -26,14 +27,23 @@
 
 #include "../e/pcb.e"
 #include "../e/asl.e"
+#include "../e/record.e"
 #include "../e/initial.e"
 #include "../e/scheduler.e"
 #include "../e/exceptions.e"
+#include "../e/profile.e"
+#include "../e/latency.e"
+#include "../e/devstats.e"
+#include "../e/ktime.e"
+#include "../e/loadavg.e"
+#include "../e/flight.e"
+#include "../e/klog.e"
+#include "../e/trace.e"
 #include "../e/interrupts.e"
 
 #include "../h/const.h"
 #include "../h/types.h"
-#include "/usr/include/uarm/libuarm.h"
+#include "uarm/libuarm.h"
 
 ////////////////////// TABLE OF CONTENTS //////////////////////
 /********************* Public Functions **********************/
@@ -44,10 +54,13 @@ HIDDEN int getLineNumber(state_t *oldINT);
 HIDDEN void lineTwoHandler();
 HIDDEN void intervalTimerHandler();
 HIDDEN void endOfQuantum();
+HIDDEN void profileTick(int now);
 HIDDEN int getDeviceNumber(unsigned int *pendingIntMap);
 HIDDEN void externalDeviceHandler(int semaphoreIndex, int trueLineNumber);
 //////////////////// END TABLE OF CONTENTS ////////////////////
 
+HIDDEN int interruptTOD; // when the interrupt being handled entered the nucleus
+
 
 /* ---- interruptHandler() ---------------------------------------
 * Parameters: 	None
@@ -69,12 +82,17 @@ void interruptHandler(){
 	// (this is a simplified 0-7 integer)
 
 	oldINT->pc = oldINT->pc - PCPREFETCH; // Decrement the PC to compensate prefetching
-	
+
 	// If something was running, update time and state
 	if(g_currentProc != NULL){
 		updateTime();
 		copyState(oldINT, &(g_currentProc->p_s));
+		interruptTOD = g_endTOD; // updateTime() just read the clock
 	}
+	else{
+		interruptTOD = getTODLO();
+	}
+	kernelEnterAt(KPINTBASE + trueLineNumber, interruptTOD);
 	
 	// The Pending Interrupts Bitmap contains the bits neccessary to determine
 	//	the device number. It is different for each device.
@@ -87,6 +105,7 @@ void interruptHandler(){
 	//	it is handled independently since it does not refer to an external device.
 	switch (trueLineNumber){
 		case LINENUMTWO:
+			TRACE(TR_INTERRUPT, g_currentProc, LINENUMTWO << 8);
 			lineTwoHandler();
 			break;
 	
@@ -111,6 +130,7 @@ void interruptHandler(){
 			break;
 		
 		default: // Handle line 0 or 1 interrupt
+			flightDump(FR_BADLINE);
 			PANIC(); // (we PANIC during getLineNumber() if no interrupt was on)
 			break;
 	}
@@ -119,6 +139,18 @@ void interruptHandler(){
 	//	be performed successfully.
 	int deviceNumber = getDeviceNumber(pendingIntMap);
 	int semaphoreIndex = getSemaphoreIndex(trueLineNumber, deviceNumber);
+	TRACE(TR_INTERRUPT, g_currentProc, (trueLineNumber << 8) | deviceNumber);
+
+	// The trace exporter's disk and the kernel log's terminal have no waiters,
+	//	they handle their own interrupts
+	if(TRACEEXPORTED(semaphoreIndex) || klogInterrupt(semaphoreIndex)){
+		if(g_currentProc != NULL){
+			g_startTOD = getTODLO();
+			kernelLeaveAt(g_startTOD);
+			loadState();
+		}
+		scheduler();
+	}
 
 	externalDeviceHandler(semaphoreIndex, trueLineNumber);
 }
@@ -152,6 +184,7 @@ HIDDEN int getLineNumber(state_t *oldINT){
 		}
 	}
 
+	flightDump(FR_NOLINE);
 	PANIC(); // 2b. no interrupt was on...
 	// or should we handle this differently? maybe ignore? or return?
 	// I mean, the interrupt handler should only be called if necessary...
@@ -162,19 +195,34 @@ HIDDEN int getLineNumber(state_t *oldINT){
 * Type: 		Private
 * Return:		None
 * Description:
-*	On a line 2 interrupt, there are two possible scenarios:
+*	On a line 2 interrupt, there are three possible scenarios:
 *		1. It was the interval timer
-*		2. It was the end of a quantum
+*		2. It was a profiler sampling tick inside the quantum
+*		3. It was the end of a quantum
 *	These are handled accordingly.
+*	While profiling, whoever was interrupted is sampled first.
 * --------------------------------- end lineTwoHandler() ---- */
 HIDDEN void lineTwoHandler(){
+	int now;
+
+	if(g_profiling && (g_currentProc != NULL)){
+		profSample(g_currentProc); // where was it when the timer went off?
+	}
 	
 	// Case 1: Interval Timer passed
 	if (getTODLO() >= g_endOfInterval){
 		intervalTimerHandler();
 	}
 
-	// Case 2: Just the end of a quantum
+	// Case 2: Only a sampling tick, the quantum isn't over yet
+	if(g_profiling && (g_profPeriod > 0) && (g_currentProc != NULL)){
+		now = getTODLO(); // one read, for the test and the rearm
+		if((g_endOfQuantum - now) > 0){
+			profileTick(now);
+		}
+	}
+
+	// Case 3: Just the end of a quantum
 	endOfQuantum();
 
 }
@@ -185,6 +233,8 @@ HIDDEN void lineTwoHandler(){
 * Return:		None
 * Description:
 *	Wake everyone up who was SYS 7 (waiting on interval timer)
+*	Replenish CPU budgets when a budget period is over
+*	Update the load averages
 *	Refill quantum/interval timers
 *	Restart the clock
 *	Return if someone was running, else get someone new
@@ -197,7 +247,9 @@ HIDDEN void intervalTimerHandler(){
 	while(observedProcess != NULL){ // until no one is left on the ASL
 		
 		observedProcess->p_semAdd = NULL; // nullify semAdd
-		insertProcQ(&(g_readyQueue), observedProcess); // put on g_readyQueue #9
+		makeReady(observedProcess); // put on g_readyQueue #9
+		latencyWoken(observedProcess, LATCLOCK, interruptTOD);
+		devStatComplete(CLOCKINDEX, FALSE, observedProcess->p_stamp);
 
 		g_softBlockCount--; // update softBlockCount
 
@@ -208,14 +260,20 @@ HIDDEN void intervalTimerHandler(){
 	g_lotOfSemaphores[CLOCKINDEX] = 0; // reset clock semaphore - no one is left
 					// that's why we broke the loop - no one waiting on it anymore
 
+	replenishBudgets(); // throttled processes may get another go
+
+	loadSample(interruptTOD); // everyone woken above is counted as ready
+	flightTick();
+
 	// Prepare for next call to schedule
-	setTIMER(QUANTUM); //reset quantum timer
+	armQuantum(QUANTUM); //reset quantum timer
 
 	g_endOfInterval = getTODLO() + INTERVAL; // reset interval timer
 					
 	// Case 1: Someone was running when the interrupt was called
 	if(g_currentProc != NULL){
 		g_startTOD = getTODLO(); // If so, start the clock
+		kernelLeaveAt(g_startTOD);
 		loadState(); // And load its state
 	}
 	
@@ -236,6 +294,9 @@ HIDDEN void endOfQuantum(){
 	
 	if(g_currentProc != NULL) // if were weren't finished,
 	{
+		TRACE(TR_QUANTUM, g_currentProc, 0);
+		g_currentProc->p_involSwitches++;
+		g_currentProc->p_stamp = g_endTOD; // interruptHandler() already called updateTime()
 		insertProcQ(&(g_readyQueue), g_currentProc); // go back on the readyQueue
 		// you're still ready, but go to the back of the line
 		g_currentProc = NULL;
@@ -244,6 +305,30 @@ HIDDEN void endOfQuantum(){
 	scheduler(); // scheduler will reset timer, so no need to worry here
 }
 
+/* ---- profileTick() ---------------------------------------
+* Parameters: 	int now (TOD, before the end of the quantum)
+* Type: 		Private
+* Return:		None
+* Description:
+*	The timer went off only so the profiler could take a sample.
+*	Rearm it for the next sample (or the rest of the quantum,
+*	whichever comes first) and go straight back. The caller has
+*	checked that some of the quantum is left, so the timer is
+*	never loaded with 0 or a negative count.
+* --------------------------------- end profileTick() ---- */
+HIDDEN void profileTick(int now){
+	int timeLeft = g_endOfQuantum - now;
+
+	if(timeLeft > g_profPeriod){
+		timeLeft = g_profPeriod;
+	}
+	setTIMER(timeLeft);
+
+	g_startTOD = now; // restart the clock
+	kernelLeaveAt(g_startTOD);
+	loadState();
+}
+
 /* ---- getDeviceNumber() ---------------------------------------
 * Parameters: 	None
 * Type: 		Private
@@ -279,6 +364,7 @@ HIDDEN int getDeviceNumber(unsigned int *pendingIntMap){
 			return i; 		// 2a. Found it!
 		}
 	}
+	flightDump(FR_NODEVICE);
 	PANIC(); // 2b. no device matches...
 	// or should we handle this differently? maybe ignore? or return?
 }
@@ -364,7 +450,9 @@ HIDDEN void externalDeviceHandler(int semaphoreIndex, int trueLineNumber){
 			interruptingDevice->dtp.command = ACK; // Shut off the alarm
 			signaledProc->p_s.a1 = interruptingDevice->dtp.status; // Return the status!
 			
-			insertProcQ(&(g_readyQueue), signaledProc); // Okay, on to the readyQueue
+			makeReady(signaledProc); // Okay, on to the readyQueue
+			latencyWoken(signaledProc, trueLineNumber - DEVICEOFFSET, interruptTOD);
+			devStatComplete(semaphoreIndex, (signaledProc->p_s.a1 & DEVSTATUSMASK) != DEVICEREADY, signaledProc->p_stamp);
 		}
 
 		// Case 2: Was a line 7 interrupt
@@ -388,7 +476,9 @@ HIDDEN void externalDeviceHandler(int semaphoreIndex, int trueLineNumber){
 					interruptingDevice->term.transm_command = ACK;
 				}
 				
-				insertProcQ(&(g_readyQueue), signaledProc); // Okay, on to the readyQueue
+				makeReady(signaledProc); // Okay, on to the readyQueue
+				latencyWoken(signaledProc, trueLineNumber - DEVICEOFFSET, interruptTOD);
+				devStatComplete(semaphoreIndex, (signaledProc->p_s.a1 & DEVSTATUSMASK) != CHARDONE, signaledProc->p_stamp);
 			}
 		}
 	}
@@ -397,6 +487,7 @@ HIDDEN void externalDeviceHandler(int semaphoreIndex, int trueLineNumber){
 	// Case 1: Someone was running when the interrupt was called
 	if(g_currentProc != NULL){
 		g_startTOD = getTODLO(); // If so, start the clock
+		kernelLeaveAt(g_startTOD);
 		loadState(); // And load its state
 	}
 	
@@ -0,0 +1,279 @@
+/**************************************************************
+* FILENAME:		klog.c
+*
+* DESCRIPTION:	Kernel Log Module for JaeOS
+*
+* NOTES:		Lets the nucleus log messages without ever waiting for a
+*				device. Each message goes into a KLOGSIZE byte ring as
+*				a line of text, "<level>message\n" with level KL_ERR
+*				(0) to KL_DEBUG (3); anything less severe than
+*				KLOGLEVEL is not kept.
+*
+*				The ring is drained to terminal KLOGTERM one character
+*				per transmit interrupt. Logging only starts the first
+*				character when the terminal is idle, and
+*				klogInterrupt() takes the terminal's interrupts before
+*				they reach externalDeviceHandler(), so no process may
+*				SYS 8 on it. Just before HALT, klogFlush() polls the
+*				rest out.
+*
+*				A message that does not fit in the space the drain has
+*				not sent yet is dropped whole and counted. If the
+*				terminal is not installed (checked before each drain
+*				starts) or fails, the drain gives up and the ring
+*				simply keeps the latest messages.
+*
+*				SYS 34 copies the log out with its own cursor, so it
+*				sees every message the drain does (unless it falls
+*				KLOGSIZE bytes behind), along with the dropped count.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/klog.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN char logRing[KLOGSIZE];
+HIDDEN unsigned int logHead;		// bytes ever written
+HIDDEN unsigned int drainTail;		// bytes ever sent to the terminal (or given up on)
+HIDDEN unsigned int readTail;		// bytes ever read by SYS 34
+HIDDEN int logDropped;				// messages that did not fit
+
+HIDDEN BOOL draining;				// a character is on its way to the terminal
+HIDDEN BOOL termDead;				// KLOGTERM failed, stop draining
+
+#define KLOGTERMREG			((termreg_t *) (DEVBASEADDRESS + (KLOGTERMINDEX * DEVWORDLENGTH)))
+#define PRINTCHR			2
+#define BYTELEN				8
+#define HEXDIGITS			8
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void klog(int level, char *msg);
+//	   void klogHex(int level, char *msg, unsigned int value);
+//	   int klogRead(char *buffer, int maxBytes, int *dropped);
+//	   BOOL klogInterrupt(int semaphoreIndex);
+//	   void klogFlush();
+/********************* Private Functions *********************/
+HIDDEN BOOL logReserve (int level, int length);
+HIDDEN void logPut (char c);
+HIDDEN void drainStep (unsigned int status);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- klog() ---------------------------------------
+* Parameters: 	int level, char *msg
+* Type: 		Public
+* Return:		None
+* Description:
+*	Log msg at level. Never waits.
+* --------------------------------- end klog() ---- */
+void klog(int level, char *msg){
+	int length = 0;
+
+	while(msg[length] != '\0'){
+		length++;
+	}
+
+	if(logReserve(level, length)){
+		while(*msg != '\0'){
+			logPut(*msg);
+			msg++;
+		}
+		logPut('\n');
+	}
+}
+
+/* ---- klogHex() ---------------------------------------
+* Parameters: 	int level, char *msg, unsigned int value
+* Type: 		Public
+* Return:		None
+* Description:
+*	Log msg followed by value in hex. Never waits.
+* --------------------------------- end klogHex() ---- */
+void klogHex(int level, char *msg, unsigned int value){
+	int length = 0;
+	int digits = 1;
+	unsigned int rest = value >> 4;
+
+	while(msg[length] != '\0'){
+		length++;
+	}
+	while(rest != 0){
+		digits++;
+		rest = rest >> 4;
+	}
+
+	if(logReserve(level, length + digits)){
+		while(*msg != '\0'){
+			logPut(*msg);
+			msg++;
+		}
+		while(digits > 0){
+			digits--;
+			logPut("0123456789abcdef"[(value >> (4 * digits)) & 0xF]);
+		}
+		logPut('\n');
+	}
+}
+
+/* ---- klogRead() ---------------------------------------
+* Parameters: 	char *buffer, int maxBytes, int *dropped (may be NULL)
+* Type: 		Public
+* Return:		Bytes copied into buffer
+* Description:
+*	Copy out log text not read yet, oldest first. If the reader
+*	fell too far behind, skip to the oldest whole line kept.
+* --------------------------------- end klogRead() ---- */
+int klogRead(char *buffer, int maxBytes, int *dropped){
+	int copied = 0;
+
+	if((logHead - readTail) > KLOGSIZE){
+		readTail = logHead - KLOGSIZE;
+		while((readTail != logHead) && (logRing[readTail & (KLOGSIZE - 1)] != '\n')){
+			readTail++;
+		}
+		if(readTail != logHead){
+			readTail++; // past the '\n'
+		}
+	}
+
+	while((copied < maxBytes) && (readTail != logHead)){
+		buffer[copied] = logRing[readTail & (KLOGSIZE - 1)];
+		copied++;
+		readTail++;
+	}
+
+	if(dropped != NULL){
+		*dropped = logDropped;
+	}
+	return (copied);
+}
+
+/* ---- klogInterrupt() ---------------------------------------
+* Parameters: 	int semaphoreIndex
+* Type: 		Public
+* Return:		TRUE if the interrupt was KLOGTERM's and has been handled
+* Description:
+*	Send the next character, or stop once the ring is empty.
+*	Anything typed on KLOGTERM is acknowledged and ignored.
+* --------------------------------- end klogInterrupt() ---- */
+BOOL klogInterrupt(int semaphoreIndex){
+	termreg_t *term = KLOGTERMREG;
+
+	if(semaphoreIndex != KLOGTERMINDEX){
+		return (FALSE);
+	}
+
+	if((term->recv_status & DEVSTATUSMASK) == CHARDONE){
+		term->recv_command = ACK;
+	}
+	if(draining && ((term->transm_status & DEVSTATUSMASK) != DEVICEBUSY)){
+		drainStep(term->transm_status);
+	}
+	else if((term->transm_status & DEVSTATUSMASK) == CHARDONE){
+		term->transm_command = ACK; // stale, the drain already gave up
+	}
+	return (TRUE);
+}
+
+/* ---- klogFlush() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called just before HALT: poll out whatever the drain has
+*	not sent yet (interrupts are off in the nucleus).
+* --------------------------------- end klogFlush() ---- */
+void klogFlush(){
+	termreg_t *term = KLOGTERMREG;
+	unsigned int status;
+
+	while(draining){
+		do {
+			status = term->transm_status;
+		} while((status & DEVSTATUSMASK) == DEVICEBUSY);
+		drainStep(status);
+	}
+}
+
+/* ---- logReserve() ---------------------------------------
+* Parameters: 	int level, int length (of the message text)
+* Type: 		Private
+* Return:		TRUE if the caller should now logPut() the message
+* Description:
+*	Filter by level, make sure the whole line fits and write
+*	its "<level>" prefix. Counts the message if it is dropped.
+* --------------------------------- end logReserve() ---- */
+HIDDEN BOOL logReserve(int level, int length){
+	if(level > KLOGLEVEL){
+		return (FALSE);
+	}
+
+	if(termDead){
+		drainTail = logHead; // nothing to wait for, overwrite the oldest
+	}
+	if((logHead - drainTail) + length + 4 > KLOGSIZE){ // "<n>" and '\n'
+		logDropped++;
+		return (FALSE);
+	}
+
+	logPut('<');
+	logPut('0' + level);
+	logPut('>');
+	return (TRUE);
+}
+
+/* ---- logPut() ---------------------------------------
+* Parameters: 	char c
+* Type: 		Private
+* Return:		None
+* Description:
+*	Append c to the ring, and start the drain if it was idle
+*	and KLOGTERM is there to take it.
+* --------------------------------- end logPut() ---- */
+HIDDEN void logPut(char c){
+	logRing[logHead & (KLOGSIZE - 1)] = c;
+	logHead++;
+
+	if(!draining && !termDead && ((KLOGTERMREG->transm_status & DEVSTATUSMASK) == DEVNOTINSTALLED)){
+		termDead = TRUE; // it would never interrupt
+		drainTail = logHead;
+	}
+	if(!draining && !termDead){
+		draining = TRUE;
+		KLOGTERMREG->transm_command = PRINTCHR | (((unsigned int) c) << BYTELEN);
+	}
+}
+
+/* ---- drainStep() ---------------------------------------
+* Parameters: 	unsigned int status (KLOGTERM's transmit status)
+* Type: 		Private
+* Return:		None
+* Description:
+*	The character at drainTail is done: acknowledge it and send
+*	the next one, if any. A failed character stops the drain.
+* --------------------------------- end drainStep() ---- */
+HIDDEN void drainStep(unsigned int status){
+	termreg_t *term = KLOGTERMREG;
+
+	term->transm_command = ACK;
+	if((status & DEVSTATUSMASK) != CHARDONE){
+		termDead = TRUE;
+		draining = FALSE;
+		drainTail = logHead;
+		return;
+	}
+
+	drainTail++;
+	if(drainTail == logHead){
+		draining = FALSE;
+		return;
+	}
+	term->transm_command = PRINTCHR | (((unsigned int) logRing[drainTail & (KLOGSIZE - 1)]) << BYTELEN);
+}
@@ -0,0 +1,222 @@
+/**************************************************************
+* FILENAME:		ktime.c
+*
+* DESCRIPTION:	Kernel Time Accounting Module for JaeOS
+*
+* NOTES:		Splits the time spent in the nucleus by path: each SYS
+*				number, SYS calls passed up, PGM and TLB traps, each
+*				interrupt line, and scheduler() choosing who runs next.
+*				Time spent in scheduler()'s WAIT is kept as idle time,
+*				so what is left of the total is process time.
+*
+*				Every entry point calls kernelEnter() (one TOD read, or
+*				kernelEnterAt() reusing one the handler made) and
+*				loadState() calls kernelLeave() (one more). When a path
+*				ends up in scheduler(), kernelSwitch() hands the rest of
+*				the entry to KPSCHED (a read), and the dispatch ends it
+*				with kernelLeaveAt() using the g_startTOD the scheduler
+*				reads anyway, so the accounting adds at most two reads to
+*				an entry. The interrupt handlers' resume paths do the
+*				same, and the interrupt entry's read doubles as its wake
+*				up latency start and the end of any idle time.
+*
+*				SYS 32 copies the totals out, optionally clearing them.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/ktime.e"
+#include "uarm/libuarm.h"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN unsigned int pathTime[KPATHS];
+HIDDEN int pathCount[KPATHS];
+HIDDEN unsigned int idleTime;
+HIDDEN unsigned int idleSinceBoot;	// like idleTime, but SYS 32 never clears it
+
+HIDDEN int currentPath = NOPATH;	// path being timed, NOPATH outside the nucleus
+HIDDEN int pathStart;				// TOD it started
+HIDDEN BOOL idling;					// in WAIT since idleStart
+HIDDEN int idleStart;
+HIDDEN int sinceTOD;				// TOD of the last reset
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   int kernelEnter(int path);
+//	   void kernelEnterAt(int path, int now);
+//	   void kernelSwitch(int path);
+//	   void kernelIdle(int now);
+//	   void kernelLeaveAt(int now);
+//	   void kernelLeave();
+//	   void kernelTimeRead(ktime_t *report, BOOL reset);
+//	   unsigned int kernelIdleTotal();
+/********************* Private Functions *********************/
+HIDDEN void chargePath (int now);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- kernelEnter() ---------------------------------------
+* Parameters: 	int path
+* Type: 		Public
+* Return:		TOD of the entry, for the caller to reuse
+* Description:
+*	The nucleus was just entered for path. Ends idle time if
+*	the processor was WAITing.
+* --------------------------------- end kernelEnter() ---- */
+int kernelEnter(int path){
+	int now = getTODLO();
+
+	kernelEnterAt(path, now);
+	return (now);
+}
+
+/* ---- kernelEnterAt() ---------------------------------------
+* Parameters: 	int path, int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	As kernelEnter(), for callers that have just read the TOD
+*	themselves (the interrupt handler).
+* --------------------------------- end kernelEnterAt() ---- */
+void kernelEnterAt(int path, int now){
+	if(idling){
+		idleTime = idleTime + (now - idleStart);
+		idleSinceBoot = idleSinceBoot + (now - idleStart);
+		idling = FALSE;
+	}
+
+	currentPath = path;
+	pathStart = now;
+	pathCount[path]++;
+}
+
+/* ---- kernelSwitch() ---------------------------------------
+* Parameters: 	int path
+* Type: 		Public
+* Return:		None
+* Description:
+*	Charge the entry so far to its path and time the rest as
+*	path (scheduler() does this). Nothing to do if it already is.
+* --------------------------------- end kernelSwitch() ---- */
+void kernelSwitch(int path){
+	int now;
+
+	if(currentPath == path){
+		return;
+	}
+
+	now = getTODLO();
+	chargePath(now);
+	currentPath = path;
+	pathStart = now;
+	pathCount[path]++;
+}
+
+/* ---- kernelIdle() ---------------------------------------
+* Parameters: 	int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	scheduler() is about to WAIT: close the current path at now
+*	and count idle time until the next kernelEnter().
+* --------------------------------- end kernelIdle() ---- */
+void kernelIdle(int now){
+	kernelLeaveAt(now);
+	idling = TRUE;
+	idleStart = now;
+}
+
+/* ---- kernelLeaveAt() ---------------------------------------
+* Parameters: 	int now
+* Type: 		Public
+* Return:		None
+* Description:
+*	The nucleus is about to return to a process and has just
+*	read the TOD itself: close the current path at now.
+* --------------------------------- end kernelLeaveAt() ---- */
+void kernelLeaveAt(int now){
+	if(currentPath != NOPATH){
+		chargePath(now);
+		currentPath = NOPATH;
+	}
+}
+
+/* ---- kernelLeave() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called by loadState(): close the current path, unless
+*	kernelLeaveAt() already did.
+* --------------------------------- end kernelLeave() ---- */
+void kernelLeave(){
+	if(currentPath != NOPATH){
+		kernelLeaveAt(getTODLO());
+	}
+}
+
+/* ---- kernelTimeRead() ---------------------------------------
+* Parameters: 	ktime_t *report, BOOL reset
+* Type: 		Public
+* Return:		None
+* Description:
+*	Copy out the time and count of every path, idle time, and
+*	how much of the total that leaves for processes. The path
+*	doing the read is only charged up to here.
+* --------------------------------- end kernelTimeRead() ---- */
+void kernelTimeRead(ktime_t *report, BOOL reset){
+	int now = getTODLO();
+	unsigned int kernelTotal = 0;
+	int i;
+
+	chargePath(now);
+	pathStart = now;
+
+	for(i = 0; i < KPATHS; i++){
+		report->k_time[i] = pathTime[i];
+		report->k_count[i] = pathCount[i];
+		kernelTotal = kernelTotal + pathTime[i];
+	}
+	report->k_idle = idleTime;
+	report->k_total = now - sinceTOD;
+	report->k_process = report->k_total - kernelTotal - idleTime;
+
+	if(reset){
+		for(i = 0; i < KPATHS; i++){
+			pathTime[i] = 0;
+			pathCount[i] = 0;
+		}
+		idleTime = 0;
+		sinceTOD = now;
+	}
+}
+
+/* ---- kernelIdleTotal() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		TOD ticks spent in WAIT since boot
+* Description:
+*	For loadavg.c, which needs a total no reset disturbs.
+*	Idle time still in progress is not counted until it ends.
+* --------------------------------- end kernelIdleTotal() ---- */
+unsigned int kernelIdleTotal(){
+	return (idleSinceBoot);
+}
+
+/* ---- chargePath() ---------------------------------------
+* Parameters: 	int now
+* Type: 		Private
+* Return:		None
+* Description:
+*	Add the time since pathStart to the current path.
+* --------------------------------- end chargePath() ---- */
+HIDDEN void chargePath(int now){
+	if(currentPath != NOPATH){
+		pathTime[currentPath] = pathTime[currentPath] + (now - pathStart);
+	}
+}
@@ -0,0 +1,114 @@
+/**************************************************************
+* FILENAME:		latency.c
+*
+* DESCRIPTION:	Wake Up Latency Module for JaeOS
+*
+* NOTES:		Measures how quickly a process runs after the device
+*				(or pseudo-clock) it waits on interrupts, in two parts:
+*					wake:		interrupt handler entry -> waiter made ready
+*					dispatch:	made ready -> scheduler dispatches it
+*
+*				Both are kept as log2 histograms for each device class
+*				(lines 3-7) and the pseudo-clock. Bucket i counts
+*				latencies of [2^i, 2^(i+1)) TOD ticks (bucket 0 also
+*				counts 0), the last bucket everything longer.
+*
+*				No extra TOD reads are needed on the wake path:
+*				makeReady() has just stamped p_stamp, which is both
+*				the end of the wake latency and the start of the
+*				dispatch latency; the scheduler's g_startTOD ends it.
+*
+*				SYS 29 copies the histograms out, optionally
+*				clearing them.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/latency.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN lathist_t histograms;
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void latencyWoken(pcb_PTR p, int latClass, int interruptTOD);
+//	   void latencyDispatched(pcb_PTR p, int dispatchTOD);
+//	   void latencyRead(lathist_t *report, BOOL reset);
+/********************* Private Functions *********************/
+HIDDEN int bucketOf (int ticks);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- latencyWoken() ---------------------------------------
+* Parameters: 	pcb_PTR p, int latClass, int interruptTOD
+* Type: 		Public
+* Return:		None
+* Description:
+*	p was just made ready by an interrupt of class latClass
+*	that entered the nucleus at interruptTOD. Record the wake
+*	latency and remember the class until p is dispatched.
+* --------------------------------- end latencyWoken() ---- */
+void latencyWoken(pcb_PTR p, int latClass, int interruptTOD){
+	histograms.l_wake[latClass][bucketOf(p->p_stamp - interruptTOD)]++;
+	p->p_wakeClass = latClass;
+}
+
+/* ---- latencyDispatched() ---------------------------------------
+* Parameters: 	pcb_PTR p, int dispatchTOD
+* Type: 		Public
+* Return:		None
+* Description:
+*	p is being dispatched at dispatchTOD. If an interrupt woke
+*	it, record how long it then sat ready.
+* --------------------------------- end latencyDispatched() ---- */
+void latencyDispatched(pcb_PTR p, int dispatchTOD){
+	if(p->p_wakeClass != NOWAKE){
+		histograms.l_dispatch[p->p_wakeClass][bucketOf(dispatchTOD - p->p_stamp)]++;
+		p->p_wakeClass = NOWAKE;
+	}
+}
+
+/* ---- latencyRead() ---------------------------------------
+* Parameters: 	lathist_t *report, BOOL reset
+* Type: 		Public
+* Return:		None
+* Description:
+*	Copy both sets of histograms out, clearing them if asked.
+* --------------------------------- end latencyRead() ---- */
+void latencyRead(lathist_t *report, BOOL reset){
+	int latClass, bucket;
+
+	for(latClass = 0; latClass < LATCLASSES; latClass++){
+		for(bucket = 0; bucket < LATBUCKETS; bucket++){
+			report->l_wake[latClass][bucket] = histograms.l_wake[latClass][bucket];
+			report->l_dispatch[latClass][bucket] = histograms.l_dispatch[latClass][bucket];
+			if(reset){
+				histograms.l_wake[latClass][bucket] = 0;
+				histograms.l_dispatch[latClass][bucket] = 0;
+			}
+		}
+	}
+}
+
+/* ---- bucketOf() ---------------------------------------
+* Parameters: 	int ticks
+* Type: 		Private
+* Return:		histogram bucket for a latency of ticks
+* Description:
+*	floor(log2(ticks)), by shifting (there is no divide on
+*	the ARM7), clamped to the histogram.
+* --------------------------------- end bucketOf() ---- */
+HIDDEN int bucketOf(int ticks){
+	int bucket = 0;
+
+	while((ticks > 1) && (bucket < (LATBUCKETS - 1))){
+		ticks = ticks >> 1;
+		bucket++;
+	}
+	return (bucket);
+}
@@ -0,0 +1,103 @@
+/**************************************************************
+* FILENAME:		loadavg.c
+*
+* DESCRIPTION:	Load Average Module for JaeOS
+*
+* NOTES:		Every pseudo-clock tick intervalTimerHandler() calls
+*				loadSample(), which counts the processes that want the
+*				processor (ready, throttled and running) plus those
+*				soft blocked on I/O or the clock, and folds that into
+*				exponentially decayed averages with 1, 5 and 15 interval
+*				time constants, as fixed point numbers with LOADSHIFT
+*				fraction bits (LOADONE is a load of 1).
+*
+*				It also works out what percent of the interval was
+*				spent in scheduler()'s WAIT, from ktime.c's idle total.
+*
+*				SYS 33 copies the lot out; it is cheap enough for a job
+*				launcher to call before every admission.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/pcb.e"
+#include "../e/initial.e"
+#include "../e/ktime.e"
+#include "../e/loadavg.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN unsigned int loads[LOADAVGS];
+HIDDEN const unsigned int loadExp[LOADAVGS] = {LOADEXP1, LOADEXP5, LOADEXP15};
+
+HIDDEN int runnable;			// at the last sample
+HIDDEN int softBlocked;
+HIDDEN int idlePercent;			// of the last interval
+HIDDEN int ticks;				// samples taken
+
+HIDDEN int lastTOD;				// when the last sample was taken
+HIDDEN unsigned int lastIdle;	// kernelIdleTotal() then
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void loadSample(int now);
+//	   void loadRead(loadavg_t *report);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- loadSample() ---------------------------------------
+* Parameters: 	int now (the TOD the interrupt was taken at)
+* Type: 		Public
+* Return:		None
+* Description:
+*	Decay the load averages towards the current load and
+*	work out how idle the interval just gone was.
+* --------------------------------- end loadSample() ---- */
+void loadSample(int now){
+	unsigned int idle = kernelIdleTotal();
+	unsigned int load;
+	int i;
+
+	runnable = procQLength(g_readyQueue) + procQLength(g_throttledQueue);
+	if(g_currentProc != NULL){
+		runnable++;
+	}
+
+	softBlocked = g_softBlockCount;
+
+	load = (runnable + softBlocked) << LOADSHIFT;
+	for(i = 0; i < LOADAVGS; i++){
+		loads[i] = ((loads[i] * loadExp[i]) + (load * (LOADONE - loadExp[i]))) >> LOADSHIFT;
+	}
+
+	// the first interval started at boot, when lastTOD was still 0
+	if(now != lastTOD){
+		idlePercent = ((idle - lastIdle) * 100) / (now - lastTOD);
+	}
+	lastTOD = now;
+	lastIdle = idle;
+	ticks++;
+}
+
+/* ---- loadRead() ---------------------------------------
+* Parameters: 	loadavg_t *report
+* Type: 		Public
+* Return:		None
+* Description:
+*	Copy out the averages and the last sample.
+* --------------------------------- end loadRead() ---- */
+void loadRead(loadavg_t *report){
+	int i;
+
+	for(i = 0; i < LOADAVGS; i++){
+		report->la_load[i] = loads[i];
+	}
+	report->la_runnable = runnable;
+	report->la_softBlocked = softBlocked;
+	report->la_idle = idlePercent;
+	report->la_ticks = ticks;
+}
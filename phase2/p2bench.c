@@ -0,0 +1,427 @@
+/*********************************P2BENCH.C*******************************
+ *
+ *	Benchmark program for the JaeOS nucleus: phase 2.
+ *
+ *	Times kernel paths with the TOD clock and prints one line per
+ *	benchmark on Terminal0:
+ *		name   operations   ticks per operation   us per operation
+ *
+ *	Built into its own image by "make bench" (kernel.bench.uarm);
+ *	kernel.core.uarm still runs p2test.
+ *
+ *	Written in the style of p2test: the root process test() sets up
+ *	a partner process for each benchmark, waits for it to finish,
+ *	and moves on to the next one.
+ *
+ *	Besides the switch benchmarks it times the null syscall (SYS 6),
+ *	create+terminate, a SYS 5 pass-up round trip, a terminal
+ *	character round trip (write + WAITIO) and the WAITCLOCK period,
+ *	whose spread is the wake up jitter. The terminal's
+ *	interrupt -> wake and wake -> dispatch latencies come from the
+ *	nucleus' own histograms (SYS 29), as the bucket holding the
+ *	median: "<N" means under N ticks.
+ *
+ *	Two user-level thread benchmarks close the table: a switch
+ *	between two yielding threads, and a thread blocking in a P while
+ *	its host's upcall activation keeps the others running. The
+ *	second PANICs if any thread never finishes.
+ *
+ *	The whole run is profiled (SYS 26-28) and the histogram is
+ *	printed at the end as "PROF pid pc count" lines; feed the
+ *	terminal log and kernel.bench.uarm to tools/profsym.
+ */
+
+#include "../e/initial.e"
+#include "../e/uthread.e"
+
+#include "uarm/libuarm.h"
+#include "uarm/arch.h"
+#include "uarm/uARMconst.h"
+
+
+#define EOS				'\0'
+
+/* hardware constants */
+#define PRINTCHR		2
+#define BYTELEN			8
+#define RECVD			5
+#define TERMSTATMASK	0xFF
+#define TERM0ADDR		DEV_REG_ADDR(7, 0)
+#define TIMESCALE		(*((unsigned int *)BUS_REG_TIME_SCALE))	/* ticks per us */
+
+#define QPAGE			1024
+#define MAXDIGITS		10
+#define HEXDIGITS		8
+
+/* how many hand offs each benchmark times */
+#define ROUNDS			1000
+#define CLOCKROUNDS		10			/* WAITCLOCKs, one INTERVAL each */
+#define TERMLINE		"................................................................\n"
+#define TERMCHARS		65
+#define TERMCLASS		(IL_TERMINAL - 3)	/* its row in the latency histograms */
+#define PASSUPSYS		9			/* above LASTSYSCALL: passed up */
+#define UTBLOCKERS		2			/* threads that block, each taking a host with it */
+#define UTRUNNERS		2			/* threads that keep going, then let them through */
+#define UTSPINS			100			/* yields each runner makes first */
+
+
+int		term_mut=1,		/* for mutual exclusion on terminal */
+		ready=0,		/* partner has started */
+		done=0,			/* partner has finished */
+		pingA=0,		/* root's half of a ping-pong */
+		pingB=0,		/* partner's half of a ping-pong */
+		utGate=0,		/* blocking threads wait here */
+		utDone=0;		/* V'd by every thread that finishes */
+
+int		rootPid,		/* so the partner knows who to YIELDTO */
+		partnerPid;		/* and vice versa */
+
+state_t	partnerState;	/* reused for every partner, one at a time */
+
+profent_t	profile[PROFBUCKETS + 1];	/* every bucket plus the overflow one */
+lathist_t	latency;
+
+state_t	sysOld, sysNew;	/* the pass-up partner's SYS trap vector */
+unsigned int passTicks;	/* what the pass-up partner timed */
+
+void	vpPartner(), yieldPartner(), yieldToPartner(), utBody();
+void	createChild(), passUpPartner(), passUpHandler(), utBlocker(), utRunner();
+
+
+/* a procedure to print on terminal 0 */
+void print(char *msg) {
+
+	char * s = msg;
+	termreg_t * base = (termreg_t *) (TERM0ADDR);
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (int)&term_mut, 0, 0);				/* P(term_mut) */
+	while (*s != EOS) {
+		base->transm_command = PRINTCHR | (((unsigned int) *s) << BYTELEN);
+		status = SYSCALL(WAITIO, IL_TERMINAL, 0, 0);
+		if ((status & TERMSTATMASK) != RECVD)
+			PANIC();
+		s++;
+	}
+	SYSCALL(VERHOGEN, (int)&term_mut, 0, 0);				/* V(term_mut) */
+}
+
+/* print an unsigned number in decimal */
+void printNum(unsigned int n) {
+	char	buf[MAXDIGITS + 1];
+	int		i = MAXDIGITS;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n = n / 10;
+	} while (n != 0);
+	print(&buf[i]);
+}
+
+/* print an unsigned number in hex, without a prefix */
+void printHex(unsigned int n) {
+	char	buf[HEXDIGITS + 1];
+	int		i = HEXDIGITS;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = "0123456789abcdef"[n & 0xF];
+		n = n >> 4;
+	} while (n != 0);
+	print(&buf[i]);
+}
+
+/* one line of the results table */
+void report(char *name, unsigned int ops, unsigned int ticks) {
+	print(name);
+	print("\t");
+	printNum(ops);
+	print("\t");
+	printNum(ticks / ops);
+	print("\t");
+	printNum((ticks / ops) / TIMESCALE);
+	print("\n");
+}
+
+/* the spread of a series of ticks, as min and max */
+void reportRange(char *name, unsigned int ops, unsigned int min, unsigned int max) {
+	print(name);
+	print("\t");
+	printNum(ops);
+	print("\t");
+	printNum(min);
+	print("-");
+	printNum(max);
+	print("\t");
+	printNum(min / TIMESCALE);
+	print("-");
+	printNum(max / TIMESCALE);
+	print("\n");
+}
+
+/* the bucket holding the median of one latency histogram row */
+void reportLatency(char *name, unsigned int *buckets) {
+	unsigned int	count = 0, seen = 0;
+	int				i;
+
+	for (i = 0; i < LATBUCKETS; i++)
+		count += buckets[i];
+	for (i = 0; (i < LATBUCKETS - 1) && ((seen + buckets[i]) * 2 < count); i++)
+		seen += buckets[i];
+	print(name);
+	print("\t");
+	printNum(count);
+	print("\t<");
+	printNum(2 << i);
+	print("\t<");
+	printNum((2 << i) / TIMESCALE + 1);
+	print("\n");
+}
+
+/* start body() as the partner process and wait until it is running */
+void startPartner(void (*body)()) {
+	partnerState.pc = (unsigned int) body;
+	SYSCALL(CREATEPROCESS, (int)&partnerState, 0, 0);
+	SYSCALL(PASSEREN, (int)&ready, 0, 0);
+}
+
+
+/* stop the profiler and print what it found */
+void dumpProfile() {
+	int	entries, i;
+
+	print("profile samples ");
+	printNum(SYSCALL(PROFSTOP, 0, 0, 0));
+	print("\n");
+
+	entries = SYSCALL(PROFREAD, (int)&profile[0], PROFBUCKETS + 1, 0);
+	for (i = 0; i < entries; i++) {
+		print("PROF ");
+		printNum(profile[i].pr_pid);
+		print(" ");
+		printHex(profile[i].pr_pc);
+		print(" ");
+		printNum(profile[i].pr_count);
+		print("\n");
+	}
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	unsigned int	start, end, last, period, min, max;
+	int				i;
+
+	print("p2bench starts\n");
+	print("benchmark\tops\tticks/op\tus/op\n");
+
+	rootPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(PROFSTART, 0, 0, 0);		/* everyone, once per quantum */
+
+	/* partners run one at a time on the page below ours */
+	STST(&partnerState);
+	partnerState.sp = partnerState.sp - QPAGE;
+	partnerState.cpsr = ALLOFF | STATUS_SYS_MODE;
+
+	/* null syscall: SYS 6 does next to nothing */
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(GETCPUTIME, 0, 0, 0);
+	end = getTODLO();
+	report("SYS 6 null", ROUNDS, end - start);
+
+	/* V+P ping-pong: every hand off is a V and a P */
+	startPartner(vpPartner);
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++) {
+		SYSCALL(VERHOGEN, (int)&pingB, 0, 0);
+		SYSCALL(PASSEREN, (int)&pingA, 0, 0);
+	}
+	end = getTODLO();
+	SYSCALL(PASSEREN, (int)&done, 0, 0);
+	report("V+P switch", 2 * ROUNDS, end - start);
+
+	/* YIELD: round robin between the two of us */
+	startPartner(yieldPartner);
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELD, 0, 0, 0);
+	end = getTODLO();
+	SYSCALL(PASSEREN, (int)&done, 0, 0);
+	report("YIELD switch", 2 * ROUNDS, end - start);
+
+	/* YIELDTO: hand the quantum straight to the partner */
+	startPartner(yieldToPartner);
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELDTO, partnerPid, 0, 0);
+	end = getTODLO();
+	SYSCALL(PASSEREN, (int)&done, 0, 0);
+	report("YIELDTO switch", 2 * ROUNDS, end - start);
+
+	/* create+terminate: each child V's done and goes, we P it */
+	partnerState.pc = (unsigned int) createChild;
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++) {
+		SYSCALL(CREATEPROCESS, (int)&partnerState, 0, 0);
+		SYSCALL(PASSEREN, (int)&done, 0, 0);
+	}
+	end = getTODLO();
+	report("create+terminate", ROUNDS, end - start);
+
+	/* SYS 5 pass-up: the partner times its own trap round trips */
+	startPartner(passUpPartner);
+	SYSCALL(PASSEREN, (int)&done, 0, 0);
+	report("SYS 5 pass-up", ROUNDS, passTicks);
+
+	/* terminal round trip: one line, a write and a WAITIO per character */
+	SYSCALL(READLATENCY, (int)&latency, TRUE, 0);
+	start = getTODLO();
+	print(TERMLINE);
+	end = getTODLO();
+	SYSCALL(READLATENCY, (int)&latency, FALSE, 0);
+	report("term char", TERMCHARS, end - start);
+	reportLatency("term int->wake", latency.l_wake[TERMCLASS]);
+	reportLatency("term wake->run", latency.l_dispatch[TERMCLASS]);
+
+	/* WAITCLOCK: the period between wake ups, and its spread */
+	min = ~0;
+	max = 0;
+	SYSCALL(WAITCLOCK, 0, 0, 0);
+	start = last = getTODLO();
+	for (i = 0; i < CLOCKROUNDS; i++) {
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+		end = getTODLO();
+		period = end - last;
+		last = end;
+		if (period < min)
+			min = period;
+		if (period > max)
+			max = period;
+	}
+	report("WAITCLOCK period", CLOCKROUNDS, end - start);
+	reportRange("WAITCLOCK min-max", CLOCKROUNDS, min, max);
+
+	/* user-level switch: two threads yielding on this process */
+	uthreadInit(partnerState.sp - (3 * QPAGE));
+	uthreadCreate(utBody, partnerState.sp - QPAGE);
+	uthreadCreate(utBody, partnerState.sp - (2 * QPAGE));
+	start = getTODLO();
+	uthreadRun();
+	end = getTODLO();
+	report("uthread switch", 2 * ROUNDS, end - start);
+
+	/* user-level block: each blocker's P starts an activation for the rest */
+	uthreadInit(partnerState.sp - ((UTBLOCKERS + UTRUNNERS + 1) * QPAGE));
+	for (i = 0; i < UTBLOCKERS; i++)
+		uthreadCreate(utBlocker, partnerState.sp - ((i + 1) * QPAGE));
+	for (i = 0; i < UTRUNNERS; i++)
+		uthreadCreate(utRunner, partnerState.sp - ((UTBLOCKERS + i + 1) * QPAGE));
+	start = getTODLO();
+	uthreadRun();
+	end = getTODLO();
+	if (utDone != UTBLOCKERS + UTRUNNERS) {
+		print("uthread block lost a thread\n");
+		PANIC();
+	}
+	report("uthread block", UTBLOCKERS, end - start);
+
+	dumpProfile();
+	print("p2bench finished\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* partner of the V+P ping-pong */
+void vpPartner() {
+	int i;
+
+	SYSCALL(VERHOGEN, (int)&ready, 0, 0);
+	for (i = 0; i < ROUNDS; i++) {
+		SYSCALL(PASSEREN, (int)&pingB, 0, 0);
+		SYSCALL(VERHOGEN, (int)&pingA, 0, 0);
+	}
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* partner of the YIELD benchmark */
+void yieldPartner() {
+	int i;
+
+	SYSCALL(VERHOGEN, (int)&ready, 0, 0);
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELD, 0, 0, 0);
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* partner of the YIELDTO benchmark */
+void yieldToPartner() {
+	int i;
+
+	partnerPid = SYSCALL(GETPID, 0, 0, 0);
+	SYSCALL(VERHOGEN, (int)&ready, 0, 0);
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(YIELDTO, rootPid, 0, 0);
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* one child of the create+terminate benchmark */
+void createChild() {
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* partner of the pass-up benchmark: its SYS handler goes straight back */
+void passUpPartner() {
+	unsigned int	start;
+	int				i;
+
+	STST(&sysNew);
+	sysNew.pc = (unsigned int) passUpHandler;
+	sysNew.sp = partnerState.sp - (QPAGE / 2);	/* clear of our own frames */
+	SYSCALL(SPECTRAPVEC, SYSTRAP, (int)&sysOld, (int)&sysNew);
+	SYSCALL(VERHOGEN, (int)&ready, 0, 0);
+
+	start = getTODLO();
+	for (i = 0; i < ROUNDS; i++)
+		SYSCALL(PASSUPSYS, 0, 0, 0);
+	passTicks = getTODLO() - start;
+
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* the pass-up partner's SYS trap handler */
+void passUpHandler() {
+	LDST(&sysOld);
+}
+
+/* both threads of the user-level switch benchmark */
+void utBody() {
+	int i;
+
+	for (i = 0; i < ROUNDS; i++)
+		uthreadYield();
+}
+
+/* a thread of the user-level block benchmark that blocks its host */
+void utBlocker() {
+	SYSCALL(PASSEREN, (int)&utGate, 0, 0);
+	SYSCALL(VERHOGEN, (int)&utDone, 0, 0);
+}
+
+/* one that runs on an activation meanwhile, then lets a blocker go */
+void utRunner() {
+	int i;
+
+	for (i = 0; i < UTSPINS; i++)
+		uthreadYield();
+	SYSCALL(VERHOGEN, (int)&utGate, 0, 0);
+	SYSCALL(VERHOGEN, (int)&utDone, 0, 0);
+}
@@ -0,0 +1,358 @@
+/*********************************P2IOBENCH.C*******************************
+ *
+ *	I/O benchmark program for the JaeOS nucleus: phase 2.
+ *
+ *	Drives one device of each class through SYS 8 and prints one
+ *	line per benchmark on Terminal0:
+ *		name  requests  bytes  requests/s  bytes/s  us per request
+ *	The last column is the average completion latency: from asking
+ *	for the device to its last interrupt, queueing included.
+ *
+ *	The benchmarks, each IOREQUESTS requests long:
+ *		disk write, disk read	IODISKBLOCKS consecutive sectors of
+ *								disk IODISK per request, seeking
+ *								when the cylinder changes
+ *		tape read				one block of tape IOTAPE, up to the
+ *								end of the tape
+ *		printer					IOLINE characters on printer IOPRINTER
+ *		terminal				IOLINE characters on terminal IOTERM
+ *	IOWORKERS processes share every device, taking requests in
+ *	turn, so the next request is already waiting when one is done.
+ *	Override any of these with make iobench IOFLAGS="-DIOWORKERS=4".
+ *
+ *	A device uARM has not got installed is reported as absent, so
+ *	the program runs unattended whatever the configuration. The
+ *	disk benchmark overwrites the start of the disk image.
+ *	SYS 8 is the only I/O path the nucleus has.
+ *
+ *	Built into its own image by "make iobench" (kernel.iobench.uarm).
+ */
+
+#include "../e/initial.e"
+
+#include "uarm/libuarm.h"
+#include "uarm/arch.h"
+#include "uarm/uARMconst.h"
+
+
+#define EOS				'\0'
+
+/* hardware constants */
+#define PRINTCHR		2
+#define BYTELEN			8
+#define RECVD			5
+#define TERMSTATMASK	0xFF
+#define TERM0ADDR		DEV_REG_ADDR(7, 0)
+#define TIMESCALE		(*((unsigned int *)BUS_REG_TIME_SCALE))	/* ticks per us */
+
+#define NOTINSTALLED	0
+#define READY			1
+#define SEEKCYL			2
+#define READBLK			3
+#define WRITEBLK		4
+#define TAPEEOT			0			/* tape marker in data1: end of tape */
+
+#define QPAGE			1024
+#define MAXDIGITS		10
+#define USPERMS			1000
+#define MSPERSEC		1000
+
+/* the benchmarks */
+#ifndef IOREQUESTS
+#define IOREQUESTS		32
+#endif
+#ifndef IOWORKERS
+#define IOWORKERS		2
+#endif
+#ifndef IODISKBLOCKS
+#define IODISKBLOCKS	1
+#endif
+#ifndef IOLINE
+#define IOLINE			64
+#endif
+#ifndef IODISK
+#define IODISK			0
+#endif
+#ifndef IOTAPE
+#define IOTAPE			0
+#endif
+#ifndef IOPRINTER
+#define IOPRINTER		0
+#endif
+#ifndef IOTERM
+#define IOTERM			1			/* terminal 0 shows the results */
+#endif
+
+#if (IOWORKERS < 1) || (IOWORKERS > MAXPROC - 1)
+#error "IOWORKERS must be between 1 and MAXPROC - 1"
+#endif
+#if (IOTERM == 0) || (IOTERM == KLOGTERM)
+#error "IOTERM must not be terminal 0 or the kernel log's terminal"
+#endif
+
+
+/* one benchmark: request() does request number n, returns its bytes, 0 to stop */
+typedef struct iobench_t {
+	char			*name;
+	int				line;
+	int				dev;
+	unsigned int	(*request)(int n);
+} iobench_t;
+
+unsigned int	diskWrite(int n), diskRead(int n), tapeRead(int n),
+				printerWrite(int n), termWrite(int n);
+
+iobench_t	benches[] = {
+	{"disk write",	IL_DISK,		IODISK,		diskWrite},
+	{"disk read",	IL_DISK,		IODISK,		diskRead},
+	{"tape read",	IL_TAPE,		IOTAPE,		tapeRead},
+	{"printer",		IL_PRINTER,		IOPRINTER,	printerWrite},
+	{"terminal",	IL_TERMINAL,	IOTERM,		termWrite}
+};
+
+int		term_mut=1,		/* for mutual exclusion on terminal */
+		device=1,		/* whoever holds it has the device to itself */
+		done=0;			/* a worker has finished */
+
+iobench_t		*bench;		/* the one running */
+int				next;		/* the next request to take, also how many were done */
+int				stop;		/* a request failed, or the tape ran out */
+unsigned int	bytes;		/* moved so far */
+unsigned int	latencySum;	/* ticks, over every request */
+int				cylinder;	/* where the disk head is, -1 unknown */
+
+unsigned int	block[DISKBLOCKSIZE / sizeof(unsigned int)];	/* disk and tape buffer */
+
+state_t	workerState;
+
+void	worker();
+
+
+/* a procedure to print on terminal 0 */
+void print(char *msg) {
+
+	char * s = msg;
+	termreg_t * base = (termreg_t *) (TERM0ADDR);
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (int)&term_mut, 0, 0);				/* P(term_mut) */
+	while (*s != EOS) {
+		base->transm_command = PRINTCHR | (((unsigned int) *s) << BYTELEN);
+		status = SYSCALL(WAITIO, IL_TERMINAL, 0, 0);
+		if ((status & TERMSTATMASK) != RECVD)
+			PANIC();
+		s++;
+	}
+	SYSCALL(VERHOGEN, (int)&term_mut, 0, 0);				/* V(term_mut) */
+}
+
+/* print an unsigned number in decimal */
+void printNum(unsigned int n) {
+	char	buf[MAXDIGITS + 1];
+	int		i = MAXDIGITS;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n = n / 10;
+	} while (n != 0);
+	print(&buf[i]);
+}
+
+/* a*b/c without overflowing 32 bits when a*b would */
+unsigned int scale(unsigned int a, unsigned int b, unsigned int c) {
+	return ((a / c) * b + ((a % c) * b) / c);
+}
+
+/* n things in us microseconds, per second */
+unsigned int perSecond(unsigned int n, unsigned int us) {
+	if (us == 0)
+		us = 1;
+	if (us >= MSPERSEC * USPERMS)
+		return (scale(n, MSPERSEC, us / USPERMS));
+	return (scale(n, MSPERSEC, us) * USPERMS);
+}
+
+/* one line of the results table */
+void report(char *name, unsigned int requests, unsigned int ticks) {
+	unsigned int us = ticks / TIMESCALE;
+
+	print(name);
+	print("\t");
+	printNum(requests);
+	print("\t");
+	printNum(bytes);
+	print("\t");
+	printNum(perSecond(requests, us));
+	print("\t");
+	printNum(perSecond(bytes, us));
+	print("\t");
+	printNum((requests == 0) ? 0 : (latencySum / requests) / TIMESCALE);
+	print("\n");
+}
+
+/* the registers of a device of a dtp class */
+dtpreg_t *dtpReg(int line, int dev) {
+	return ((dtpreg_t *) DEV_REG_ADDR(line, dev));
+}
+
+/* TRUE if uARM has the device */
+int installed(iobench_t *b) {
+	if (b->line == IL_TERMINAL)
+		return (((termreg_t *) DEV_REG_ADDR(b->line, b->dev))->transm_status != NOTINSTALLED);
+	return (dtpReg(b->line, b->dev)->status != NOTINSTALLED);
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	unsigned int	start, end, stackTop;
+	int				i, j;
+
+	print("p2iobench starts\n");
+	print("benchmark\treqs\tbytes\treqs/s\tbytes/s\tus/req\n");
+
+	/* workers run one benchmark at a time, each on a page below ours */
+	STST(&workerState);
+	stackTop = workerState.sp;
+	workerState.pc = (unsigned int) worker;
+	workerState.cpsr = ALLOFF | STATUS_SYS_MODE;
+
+	for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+		bench = &benches[i];
+		if (!installed(bench)) {
+			print(bench->name);
+			print("\tabsent\n");
+			continue;
+		}
+		next = 0;
+		stop = FALSE;
+		bytes = 0;
+		latencySum = 0;
+		cylinder = -1;
+
+		start = getTODLO();
+		for (j = 0; j < IOWORKERS; j++) {
+			workerState.sp = stackTop - ((j + 1) * QPAGE);
+			SYSCALL(CREATEPROCESS, (int)&workerState, 0, 0);
+		}
+		for (j = 0; j < IOWORKERS; j++)
+			SYSCALL(PASSEREN, (int)&done, 0, 0);
+		end = getTODLO();
+
+		report(bench->name, next, end - start);
+	}
+
+	print("p2iobench finished\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* take requests until there are none left, timing each one */
+void worker() {
+	unsigned int	start, moved;
+	int				n;
+
+	for (;;) {
+		start = getTODLO();
+		SYSCALL(PASSEREN, (int)&device, 0, 0);
+		if (stop || (next >= IOREQUESTS)) {
+			SYSCALL(VERHOGEN, (int)&device, 0, 0);
+			break;
+		}
+		n = next;
+		moved = bench->request(n);
+		if (moved == 0)
+			stop = TRUE;		/* everyone stops, this one does not count */
+		else {
+			next = n + 1;
+			bytes += moved;
+			latencySum += getTODLO() - start;
+		}
+		SYSCALL(VERHOGEN, (int)&device, 0, 0);
+	}
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+/* start command on a dtp device and wait for it, TRUE if it went well */
+int dtpCommand(int line, int dev, unsigned int command) {
+	dtpReg(line, dev)->command = command;
+	return ((SYSCALL(WAITIO, line, dev, 0) & TERMSTATMASK) == READY);
+}
+
+/* sectors [n * IODISKBLOCKS, (n + 1) * IODISKBLOCKS) of the disk, read or written */
+unsigned int diskBlocks(int n, int command) {
+	dtpreg_t		*disk = dtpReg(IL_DISK, IODISK);
+	unsigned int	heads = (disk->data1 >> 8) & 0xFF;
+	unsigned int	sectors = disk->data1 & 0xFF;
+	unsigned int	sector, cyl;
+	int				i;
+
+	for (i = 0; i < IODISKBLOCKS; i++) {
+		sector = (n * IODISKBLOCKS) + i;
+		cyl = sector / (heads * sectors);
+		if (cyl >= (disk->data1 >> 16))
+			return (0);		/* past the end of the disk */
+		if ((cyl != cylinder) && !dtpCommand(IL_DISK, IODISK, (cyl << BYTELEN) | SEEKCYL))
+			return (0);
+		cylinder = cyl;
+		disk->data0 = (unsigned int) &block[0];
+		if (!dtpCommand(IL_DISK, IODISK,
+				(((sector / sectors) % heads) << 16) | ((sector % sectors) << BYTELEN) | command))
+			return (0);
+	}
+	return (IODISKBLOCKS * DISKBLOCKSIZE);
+}
+
+unsigned int diskWrite(int n) {
+	block[0] = n;
+	return (diskBlocks(n, WRITEBLK));
+}
+
+unsigned int diskRead(int n) {
+	return (diskBlocks(n, READBLK));
+}
+
+/* the next block of the tape */
+unsigned int tapeRead(int n) {
+	dtpreg_t *tape = dtpReg(IL_TAPE, IOTAPE);
+
+	if (tape->data1 == TAPEEOT)
+		return (0);
+	tape->data0 = (unsigned int) &block[0];
+	if (!dtpCommand(IL_TAPE, IOTAPE, READBLK))
+		return (0);
+	return (DISKBLOCKSIZE);
+}
+
+/* a line on the printer, one character at a time */
+unsigned int printerWrite(int n) {
+	dtpreg_t	*printer = dtpReg(IL_PRINTER, IOPRINTER);
+	int			i;
+
+	for (i = 0; i < IOLINE; i++) {
+		printer->data0 = (i == IOLINE - 1) ? '\n' : 'a' + (n % 26);
+		if (!dtpCommand(IL_PRINTER, IOPRINTER, PRINTCHR))
+			return (0);
+	}
+	return (IOLINE);
+}
+
+/* a line on the terminal, one character at a time */
+unsigned int termWrite(int n) {
+	termreg_t		*term = (termreg_t *) DEV_REG_ADDR(IL_TERMINAL, IOTERM);
+	unsigned int	c;
+	int				i;
+
+	for (i = 0; i < IOLINE; i++) {
+		c = (i == IOLINE - 1) ? '\n' : 'a' + (n % 26);
+		term->transm_command = PRINTCHR | (c << BYTELEN);
+		if ((SYSCALL(WAITIO, IL_TERMINAL, IOTERM, 0) & TERMSTATMASK) != RECVD)
+			return (0);
+	}
+	return (IOLINE);
+}
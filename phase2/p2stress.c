@@ -0,0 +1,261 @@
+/*********************************P2STRESS.C*******************************
+ *
+ *	Stress program for the JaeOS nucleus: phase 2.
+ *
+ *	Where p2test runs each feature once with fixed process shapes,
+ *	this one builds a workload from compiled-in parameters, runs it
+ *	for a while and measures itself. Override any of them on the
+ *	command line, e.g. make stress STRESSFLAGS="-DSTRESSPROCS=12":
+ *		STRESSPROCS		worker processes (the root makes MAXPROC at most)
+ *		STRESSDEPTH		depth of the process tree they form
+ *		STRESSCPU		percent of operations that are CPU bursts
+ *		STRESSPV		percent that are a P, a short critical section, a V
+ *		STRESSIO		percent that block for I/O (a WAITCLOCK)
+ *		STRESSSEMS		semaphores the P/V operations pick from
+ *		STRESSSECS		how long the workers run, in seconds
+ *
+ *	The root process test() starts STRESSPROCS / STRESSDEPTH chains
+ *	of workers, each worker creating the next one down its chain.
+ *	Every worker picks operations at random with the mix above until
+ *	the time is up, then reports how many it did, its CPU time
+ *	(SYS 6) and its longest wait in a P, and parks. The root prints
+ *	the totals on Terminal0:
+ *		operations per second over every worker, over the measured run
+ *		CPU time of the least and most served worker, and min/max
+ *		the longest any P waited
+ *	and terminates, taking the whole tree with it.
+ *
+ *	Built into its own image by "make stress" (kernel.stress.uarm).
+ */
+
+#include "../e/initial.e"
+
+#include "uarm/libuarm.h"
+#include "uarm/arch.h"
+#include "uarm/uARMconst.h"
+
+
+#define EOS				'\0'
+
+/* hardware constants */
+#define PRINTCHR		2
+#define BYTELEN			8
+#define RECVD			5
+#define TERMSTATMASK	0xFF
+#define TERM0ADDR		DEV_REG_ADDR(7, 0)
+#define TIMESCALE		(*((unsigned int *)BUS_REG_TIME_SCALE))	/* ticks per us */
+
+#define QPAGE			1024
+#define MAXDIGITS		10
+
+/* the workload */
+#ifndef STRESSPROCS
+#define STRESSPROCS		(MAXPROC - 1)
+#endif
+#ifndef STRESSDEPTH
+#define STRESSDEPTH		3
+#endif
+#ifndef STRESSCPU
+#define STRESSCPU		50
+#endif
+#ifndef STRESSPV
+#define STRESSPV		40
+#endif
+#ifndef STRESSIO
+#define STRESSIO		10
+#endif
+#ifndef STRESSSEMS
+#define STRESSSEMS		4
+#endif
+#ifndef STRESSSECS
+#define STRESSSECS		5
+#endif
+
+#if (STRESSPROCS < 1) || (STRESSPROCS > MAXPROC - 1)
+#error "STRESSPROCS must be between 1 and MAXPROC - 1"
+#endif
+#if (STRESSDEPTH < 1) || (STRESSDEPTH > STRESSPROCS)
+#error "STRESSDEPTH must be between 1 and STRESSPROCS"
+#endif
+#if (STRESSCPU + STRESSPV + STRESSIO) != 100
+#error "STRESSCPU, STRESSPV and STRESSIO must add up to 100"
+#endif
+
+#define CHAINS			((STRESSPROCS + STRESSDEPTH - 1) / STRESSDEPTH)
+#define BURST			200			/* loop iterations in a CPU burst */
+#define CRITICAL		20			/* and in a critical section */
+#define MSPERSEC		1000
+#define USPERMS			1000
+
+
+int		term_mut=1,		/* for mutual exclusion on terminal */
+		done=0,			/* a worker has reported */
+		park=0,			/* where workers wait to be terminated */
+		go=0;			/* the deadline is set */
+
+int		sems[STRESSSEMS];			/* what the P/V operations contend on */
+
+state_t	workerState[STRESSPROCS];	/* one page of stack each */
+
+unsigned int	deadline;			/* TOD at which the workers stop */
+
+/* what each worker reports */
+unsigned int	workerOps[STRESSPROCS];
+unsigned int	workerCpu[STRESSPROCS];
+unsigned int	workerWait[STRESSPROCS];
+
+void	worker();
+
+
+/* a procedure to print on terminal 0 */
+void print(char *msg) {
+
+	char * s = msg;
+	termreg_t * base = (termreg_t *) (TERM0ADDR);
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (int)&term_mut, 0, 0);				/* P(term_mut) */
+	while (*s != EOS) {
+		base->transm_command = PRINTCHR | (((unsigned int) *s) << BYTELEN);
+		status = SYSCALL(WAITIO, IL_TERMINAL, 0, 0);
+		if ((status & TERMSTATMASK) != RECVD)
+			PANIC();
+		s++;
+	}
+	SYSCALL(VERHOGEN, (int)&term_mut, 0, 0);				/* V(term_mut) */
+}
+
+/* print an unsigned number in decimal */
+void printNum(unsigned int n) {
+	char	buf[MAXDIGITS + 1];
+	int		i = MAXDIGITS;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n = n / 10;
+	} while (n != 0);
+	print(&buf[i]);
+}
+
+/* one "name value" line */
+void printLine(char *name, unsigned int value) {
+	print(name);
+	print(" ");
+	printNum(value);
+	print("\n");
+}
+
+/* a*b/c without overflowing 32 bits when a*b would */
+unsigned int scale(unsigned int a, unsigned int b, unsigned int c) {
+	return ((a / c) * b + ((a % c) * b) / c);
+}
+
+/* start worker id, at depth id / CHAINS of chain id % CHAINS */
+void startWorker(int id) {
+	SYSCALL(CREATEPROCESS, (int)&workerState[id], 0, 0);
+}
+
+
+/*                                                                   */
+/*                 test -- the root process                          */
+/*                                                                   */
+void test() {
+	unsigned int	ops = 0, cpuMin = ~0, cpuMax = 0, waitMax = 0, start, ms;
+	int				i;
+
+	print("p2stress starts\n");
+	printLine("procs", STRESSPROCS);
+	printLine("depth", STRESSDEPTH);
+	printLine("cpu%", STRESSCPU);
+	printLine("pv%", STRESSPV);
+	printLine("io%", STRESSIO);
+	printLine("sems", STRESSSEMS);
+	printLine("secs", STRESSSECS);
+
+	for (i = 0; i < STRESSSEMS; i++)
+		sems[i] = 1;
+
+	/* every worker on its own page below ours */
+	STST(&workerState[0]);
+	for (i = 0; i < STRESSPROCS; i++) {
+		workerState[i] = workerState[0];
+		workerState[i].sp = workerState[0].sp - ((i + 1) * QPAGE);
+		workerState[i].pc = (unsigned int) worker;
+		workerState[i].a1 = i;
+		workerState[i].cpsr = ALLOFF | STATUS_SYS_MODE;
+	}
+
+	/* the heads of the chains, which start the rest */
+	for (i = 0; i < CHAINS; i++)
+		startWorker(i);
+
+	start = getTODLO();
+	deadline = start + (STRESSSECS * MSPERSEC * USPERMS * TIMESCALE);
+	for (i = 0; i < STRESSPROCS; i++)
+		SYSCALL(VERHOGEN, (int)&go, 0, 0);
+
+	for (i = 0; i < STRESSPROCS; i++)
+		SYSCALL(PASSEREN, (int)&done, 0, 0);
+	ms = ((getTODLO() - start) / TIMESCALE) / USPERMS;	/* the last one finishes late */
+
+	for (i = 0; i < STRESSPROCS; i++) {
+		ops += workerOps[i];
+		if (workerCpu[i] < cpuMin)
+			cpuMin = workerCpu[i];
+		if (workerCpu[i] > cpuMax)
+			cpuMax = workerCpu[i];
+		if (workerWait[i] > waitMax)
+			waitMax = workerWait[i];
+	}
+
+	printLine("ops", ops);
+	printLine("ms", ms);
+	printLine("ops/sec", scale(ops, MSPERSEC, ms));
+	printLine("cpu min us", cpuMin / TIMESCALE);
+	printLine("cpu max us", cpuMax / TIMESCALE);
+	printLine("cpu min/max %", (cpuMax == 0) ? 100 : scale(cpuMin, 100, cpuMax));
+	printLine("max P wait us", waitMax / TIMESCALE);
+
+	print("p2stress finished\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);		/* and every worker with us */
+}
+
+
+/* one worker: start the next one down the chain, then run the mix */
+void worker(int id) {
+	unsigned int	seed = (id * 2654435761U) + 1, pick, before, wait;
+	int				i, sem;
+
+	if (id + CHAINS < STRESSPROCS)
+		startWorker(id + CHAINS);
+	SYSCALL(PASSEREN, (int)&go, 0, 0);
+
+	while ((int) (getTODLO() - deadline) < 0) {
+		seed = (seed * 1103515245) + 12345;
+		pick = (seed >> 16) % 100;
+
+		if (pick < STRESSCPU) {
+			for (i = 0; i < BURST; i++)
+				;
+		}
+		else if (pick < STRESSCPU + STRESSPV) {
+			sem = (seed >> 8) % STRESSSEMS;
+			before = getTODLO();
+			SYSCALL(PASSEREN, (int)&sems[sem], 0, 0);
+			wait = getTODLO() - before;
+			if (wait > workerWait[id])
+				workerWait[id] = wait;
+			for (i = 0; i < CRITICAL; i++)
+				;
+			SYSCALL(VERHOGEN, (int)&sems[sem], 0, 0);
+		}
+		else
+			SYSCALL(WAITCLOCK, 0, 0, 0);
+		workerOps[id]++;
+	}
+
+	workerCpu[id] = SYSCALL(GETCPUTIME, 0, 0, 0);
+	SYSCALL(VERHOGEN, (int)&done, 0, 0);
+	SYSCALL(PASSEREN, (int)&park, 0, 0);
+}
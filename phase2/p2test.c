@@ -20,10 +20,10 @@
 */
 #include "../e/initial.e"
 
-#include "/usr/include/uarm/libuarm.h"
-//#include "/usr/include/uarm/uARMtypes.h"
-#include "/usr/include/uarm/arch.h"
-#include "/usr/include/uarm/uARMconst.h"
+#include "uarm/libuarm.h"
+//#include "uarm/uARMtypes.h"
+#include "uarm/arch.h"
+#include "uarm/uARMconst.h"
 
 
 #define ALLOFF				0x00000000
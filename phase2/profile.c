@@ -0,0 +1,162 @@
+/**************************************************************
+* FILENAME:		profile.c
+*
+* DESCRIPTION:	PC-Sampling Profiler Module for JaeOS
+*
+* NOTES:		Finds out where processes spend their CPU time without
+*				touching their code: every line 2 interrupt that
+*				preempts a process records the PC it was at.
+*
+*				Samples are counted in one histogram keyed by
+*				(PID, PC), an open addressed hash table of PROFBUCKETS
+*				buckets. Once it is full, samples for new pairs are
+*				counted in a catch-all bucket (PID 0, PC 0) so the
+*				totals still add up.
+*
+*				By default a process is sampled once per quantum (and
+*				at the end of each pseudo-clock interval). PROFSTART
+*				can ask for a shorter period: the scheduler then
+*				arms the timer for the period instead of the whole
+*				slice, and lineTwoHandler() tells these sampling ticks
+*				apart from the real end of the quantum (g_endOfQuantum).
+*
+*				SYS 26 starts (and clears) a profile, SYS 27 stops
+*				it, SYS 28 copies the histogram out. A test program
+*				can print the entries as "PROF pid pc count" lines,
+*				which tools/profsym turns into a flat profile.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/initial.e"
+#include "../e/profile.e"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN profent_t profTable[PROFBUCKETS];
+HIDDEN int profOverflow;				// samples that found no free bucket
+HIDDEN int profSamples;					// samples taken since PROFSTART
+HIDDEN int profPid;						// only sample this PID, PROFALLPROCS for everyone
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void profStart(int pid, int period);
+//	   int profStop();
+//	   int profRead(profent_t *buffer, int maxEntries);
+//	   void profSample(pcb_PTR p);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- profStart() ---------------------------------------
+* Parameters: 	int pid, int period
+* Type: 		Public
+* Return:		None
+* Description:
+*	Clear the histogram and start sampling pid (or everyone),
+*	every period microseconds of CPU, or only at line 2
+*	interrupts if period is 0 or not shorter than a QUANTUM.
+* --------------------------------- end profStart() ---- */
+void profStart(int pid, int period){
+	int i;
+
+	for(i = 0; i < PROFBUCKETS; i++){
+		profTable[i].pr_pid = 0;
+		profTable[i].pr_pc = 0;
+		profTable[i].pr_count = 0;
+	}
+	profOverflow = 0;
+	profSamples = 0;
+	profPid = pid;
+
+	g_profPeriod = 0;
+	if((period > 0) && (period < QUANTUM)){
+		g_profPeriod = period;
+	}
+	g_profiling = TRUE;
+}
+
+/* ---- profStop() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		Samples taken since profStart()
+* Description:
+*	Stop sampling. The histogram is kept until the next start.
+*	The timer goes back to whole slices at the next dispatch.
+* --------------------------------- end profStop() ---- */
+int profStop(){
+	g_profiling = FALSE;
+	g_profPeriod = 0;
+	return (profSamples);
+}
+
+/* ---- profRead() ---------------------------------------
+* Parameters: 	profent_t *buffer, int maxEntries
+* Type: 		Public
+* Return:		Number of entries copied into buffer
+* Description:
+*	Copy out up to maxEntries non-empty buckets, in table order,
+*	followed by the catch-all (PID 0, PC 0) bucket if anything
+*	overflowed.
+* --------------------------------- end profRead() ---- */
+int profRead(profent_t *buffer, int maxEntries){
+	int i;
+	int copied = 0;
+
+	for(i = 0; (i < PROFBUCKETS) && (copied < maxEntries); i++){
+		if(profTable[i].pr_count != 0){
+			buffer[copied] = profTable[i];
+			copied++;
+		}
+	}
+
+	if((profOverflow != 0) && (copied < maxEntries)){
+		buffer[copied].pr_pid = 0;
+		buffer[copied].pr_pc = 0;
+		buffer[copied].pr_count = profOverflow;
+		copied++;
+	}
+
+	return (copied);
+}
+
+/* ---- profSample() ---------------------------------------
+* Parameters: 	pcb_PTR p
+* Type: 		Public
+* Return:		None
+* Description:
+*	Count one sample at p's saved PC (the interrupt handler has
+*	already copied the interrupted state into p_s). Linear probing
+*	from a hash of the PC and PID; the table is never emptied while
+*	sampling, so the first empty bucket means the pair is new.
+* --------------------------------- end profSample() ---- */
+void profSample(pcb_PTR p){
+	unsigned int pc = p->p_s.pc;
+	unsigned int slot;
+	int probes;
+
+	if((profPid != PROFALLPROCS) && (p->p_pid != profPid)){
+		return;
+	}
+	profSamples++;
+
+	slot = ((pc >> 2) ^ (p->p_pid * 2654435761u)) & (PROFBUCKETS - 1);
+	for(probes = 0; probes < PROFBUCKETS; probes++){
+		if(profTable[slot].pr_count == 0){ // new pair
+			profTable[slot].pr_pid = p->p_pid;
+			profTable[slot].pr_pc = pc;
+			profTable[slot].pr_count = 1;
+			return;
+		}
+		if((profTable[slot].pr_pc == pc) && (profTable[slot].pr_pid == p->p_pid)){
+			profTable[slot].pr_count++;
+			return;
+		}
+		slot = (slot + 1) & (PROFBUCKETS - 1);
+	}
+
+	profOverflow++; // full
+}
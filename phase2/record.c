@@ -0,0 +1,300 @@
+/**************************************************************
+* FILENAME:		record.c
+*
+* DESCRIPTION:	Phase 1 Call Recorder Module for JaeOS
+*
+* NOTES:		Built with -DKRECORD (make RECORDFLAGS=-DKRECORD), the
+*				nucleus logs every call it makes into the ProcBlk and
+*				ASL modules, so a real workload can be replayed on the
+*				host against other implementations of them (see
+*				host/replay.c). record.e sends the calls through the
+*				wrappers here; the modules' own calls to each other
+*				are not recorded, since they belong to whichever
+*				implementation is being replayed.
+*
+*				Arguments are recorded as small names rather than
+*				addresses: a ProcBlk by its slot (pcbSlot()), and a
+*				semaphore or queue tail pointer by the order it was
+*				first seen in. Every call is one word,
+*					(op << 24) | (a << 16) | (b << 8) | r
+*				with op one of the RC_ constants and r the result,
+*				so a replay can check it took the same path.
+*
+*				Recording stops once RECORDSIZE calls are kept, so
+*				a long run leaves a trace of its beginning, which
+*				still replays (a trace with a gap would not). Just
+*				before HALT, recordDump() prints the trace on
+*				terminal 0 through tprint(), after everything the
+*				processes printed:
+*
+*					REC calls lost semaphores queues
+*					S name address			(one per semaphore)
+*					C word					(one per call, in order)
+*					END
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#define RECORDER 	// the wrappers call the real modules
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/pcb.e"
+#include "../e/asl.e"
+#include "../e/record.e"
+#include "uarm/libuarm.h"
+
+#ifdef KRECORD
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN unsigned int recording[RECORDSIZE];
+HIDDEN unsigned int recordCount;		// calls kept
+HIDDEN unsigned int recordLost;			// calls after the buffer filled
+
+HIDDEN int *semNames[RECSEMS];			// semaphore address of each name
+HIDDEN int semCount;
+HIDDEN pcb_PTR *queueNames[RECQUEUES];	// queue tail pointer address of each name
+HIDDEN int queueCount;
+
+#define HEXDIGITS			8
+#define LINELENGTH			32
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   the rec*() wrappers, one per recorded call (see record.e)
+//	   void recordDump();
+/********************* Private Functions *********************/
+HIDDEN void recordCall (int op, int a, int b, int r);
+HIDDEN int pcbName (pcb_PTR p);
+HIDDEN int semName (int *semAdd);
+HIDDEN int queueName (pcb_PTR *tp);
+HIDDEN char *appendHex (char *line, unsigned int n);
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+pcb_PTR recAllocPcb(){
+	pcb_PTR p = allocPcb();
+
+	recordCall(RC_ALLOCPCB, 0, 0, pcbName(p));
+	return (p);
+}
+
+void recFreePcb(pcb_PTR p){
+	recordCall(RC_FREEPCB, pcbName(p), 0, 0); // while its slot is still in use
+	freePcb(p);
+}
+
+void recInsertProcQ(pcb_PTR *tp, pcb_PTR p){
+	recordCall(RC_INSERTPROCQ, queueName(tp), pcbName(p), 0);
+	insertProcQ(tp, p);
+}
+
+pcb_PTR recRemoveProcQ(pcb_PTR *tp){
+	pcb_PTR p = removeProcQ(tp);
+
+	recordCall(RC_REMOVEPROCQ, queueName(tp), 0, pcbName(p));
+	return (p);
+}
+
+pcb_PTR recOutProcQ(pcb_PTR *tp, pcb_PTR p){
+	pcb_PTR out = outProcQ(tp, p);
+
+	recordCall(RC_OUTPROCQ, queueName(tp), pcbName(p), pcbName(out));
+	return (out);
+}
+
+pcb_PTR recHeadProcQ(pcb_PTR tp){
+	pcb_PTR head = headProcQ(tp);
+
+	recordCall(RC_HEADPROCQ, pcbName(tp), 0, pcbName(head));
+	return (head);
+}
+
+void recInsertChild(pcb_PTR prnt, pcb_PTR p){
+	recordCall(RC_INSERTCHILD, pcbName(prnt), pcbName(p), 0);
+	insertChild(prnt, p);
+}
+
+pcb_PTR recRemoveChild(pcb_PTR prnt){
+	pcb_PTR child = removeChild(prnt);
+
+	recordCall(RC_REMOVECHILD, pcbName(prnt), 0, pcbName(child));
+	return (child);
+}
+
+pcb_PTR recOutChild(pcb_PTR p){
+	pcb_PTR child = outChild(p);
+
+	recordCall(RC_OUTCHILD, pcbName(p), 0, pcbName(child));
+	return (child);
+}
+
+int recInsertBlocked(int *semAdd, pcb_PTR p){
+	int result = insertBlocked(semAdd, p);
+
+	recordCall(RC_INSERTBLOCKED, semName(semAdd), pcbName(p), result);
+	return (result);
+}
+
+pcb_PTR recRemoveBlocked(int *semAdd){
+	pcb_PTR p = removeBlocked(semAdd);
+
+	recordCall(RC_REMOVEBLOCKED, semName(semAdd), 0, pcbName(p));
+	return (p);
+}
+
+pcb_PTR recOutBlocked(pcb_PTR p){
+	pcb_PTR out = outBlocked(p);
+
+	recordCall(RC_OUTBLOCKED, pcbName(p), 0, pcbName(out));
+	return (out);
+}
+
+pcb_PTR recHeadBlocked(int *semAdd){
+	pcb_PTR head = headBlocked(semAdd);
+
+	recordCall(RC_HEADBLOCKED, semName(semAdd), 0, pcbName(head));
+	return (head);
+}
+
+/* ---- recordDump() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Print the names and the calls on terminal 0, in the format
+*	given above. Called just before HALT, when every process
+*	is done with the terminal.
+* --------------------------------- end recordDump() ---- */
+void recordDump(){
+	char line[LINELENGTH];
+	char *end;
+	unsigned int i;
+
+	end = appendHex(line, recordCount);
+	end = appendHex(end, recordLost);
+	end = appendHex(end, semCount);
+	end = appendHex(end, queueCount);
+	end[-1] = '\n';
+	*end = '\0';
+	tprint("REC ");
+	tprint(line);
+
+	for(i = 0; i < semCount; i++){
+		end = appendHex(line, i);
+		end = appendHex(end, (unsigned int) semNames[i]);
+		end[-1] = '\n';
+		*end = '\0';
+		tprint("S ");
+		tprint(line);
+	}
+
+	for(i = 0; i < recordCount; i++){
+		end = appendHex(line, recording[i]);
+		end[-1] = '\n';
+		*end = '\0';
+		tprint("C ");
+		tprint(line);
+	}
+
+	tprint("END\n");
+}
+
+/* ---- recordCall() ---------------------------------------
+* Parameters: 	the RC_ op and its three names
+* Type: 		Private
+* Return:		None
+* --------------------------------- end recordCall() ---- */
+HIDDEN void recordCall(int op, int a, int b, int r){
+	if(recordCount == RECORDSIZE){
+		recordLost++;
+		return;
+	}
+	recording[recordCount] = (op << 24) | ((a & 0xFF) << 16) | ((b & 0xFF) << 8) | (r & 0xFF);
+	recordCount++;
+}
+
+/* ---- pcbName() ---------------------------------------
+* Parameters: 	pcb_PTR p (may be NULL)
+* Type: 		Private
+* Return:		p's slot, RC_NONE for NULL
+* --------------------------------- end pcbName() ---- */
+HIDDEN int pcbName(pcb_PTR p){
+	int slot;
+
+	for(slot = 0; (p != NULL) && (slot < MAXPROC); slot++){
+		if(pcbSlot(slot) == p){
+			return (slot);
+		}
+	}
+	return (RC_NONE);
+}
+
+/* ---- semName() ---------------------------------------
+* Parameters: 	int *semAdd
+* Type: 		Private
+* Return:		its name, a new one if it was never seen
+* --------------------------------- end semName() ---- */
+HIDDEN int semName(int *semAdd){
+	int i;
+
+	for(i = 0; i < semCount; i++){
+		if(semNames[i] == semAdd){
+			return (i);
+		}
+	}
+	if(semCount == RECSEMS){
+		return (RC_NONE);
+	}
+	semNames[semCount] = semAdd;
+	semCount++;
+	return (semCount - 1);
+}
+
+/* ---- queueName() ---------------------------------------
+* Parameters: 	pcb_PTR *tp
+* Type: 		Private
+* Return:		its name, a new one if it was never seen
+* --------------------------------- end queueName() ---- */
+HIDDEN int queueName(pcb_PTR *tp){
+	int i;
+
+	for(i = 0; i < queueCount; i++){
+		if(queueNames[i] == tp){
+			return (i);
+		}
+	}
+	if(queueCount == RECQUEUES){
+		return (RC_NONE);
+	}
+	queueNames[queueCount] = tp;
+	queueCount++;
+	return (queueCount - 1);
+}
+
+/* ---- appendHex() ---------------------------------------
+* Parameters: 	char *line, unsigned int n
+* Type: 		Private
+* Return:		where the next word goes
+* Description:
+*	Write n in hex and a space at line.
+* --------------------------------- end appendHex() ---- */
+HIDDEN char *appendHex(char *line, unsigned int n){
+	char buf[HEXDIGITS];
+	int i = HEXDIGITS;
+
+	do {
+		buf[--i] = "0123456789abcdef"[n & 0xF];
+		n = n >> 4;
+	} while(n != 0);
+	while(i < HEXDIGITS){
+		*line++ = buf[i++];
+	}
+	*line++ = ' ';
+	return (line);
+}
+
+#endif
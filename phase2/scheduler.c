@@ -17,6 +17,8 @@
 *						Count is zero. Take an appropriate deadlock detected action.
 *						(e.g. Invoke the PANIC ROM service/instruction.)
 *					3. If the Process Count > 0 and the Soft-block Count > 0 enter a Wait State.
+*						Processes throttled for CPU budget wait for the clock too,
+*						so they also count as a reason to wait.
 *			
 *				If it is in neither an error, complete, nor wait state,
 *					1. Put time on the interval timer.
@@ -24,6 +26,20 @@
 *						(before calling load state on the state on the PCB)
 *					3. Store it in the global variable for startTOD
 *
+*				CPU budgets are charged from updateTime() and enforced here:
+*					a process whose budget (or an ancestor's subtree budget)
+*					has run out is parked on g_throttledQueue, or killed,
+*					instead of being dispatched. Every BUDGETPERIOD intervals
+*					the pseudo-clock replenishes them all at once.
+*
+*				Scheduling counters reuse the TOD reads that are already there:
+*					blocking and preemption stamp p_stamp with the g_endTOD
+*					updateTime() just read, makeReady() reads the TOD once to
+*					close the blocked interval and open the ready one, and
+*					dispatch closes the ready interval with the g_startTOD read.
+*					Time parked by SUSPENDGROUP is not ready time: parking
+*					closes the ready interval and RESUMEGROUP opens a new one.
+*
 * AUTHORS:		Thomas Reichman; Ajiri Obaebor
 *				Some descriptions adapted from Michael Goldweber
 *				Debugging help from Patrick and Neal
@@ -32,22 +48,35 @@
 **************************************************************/
 
 #include "../e/pcb.e"
+#include "../e/record.e"
 #include "../e/initial.e"
 #include "../e/scheduler.e"
 #include "../e/exceptions.e"
+#include "../e/trace.e"
+#include "../e/latency.e"
+#include "../e/ktime.e"
+#include "../e/flight.e"
+#include "../e/klog.e"
 
 #include "../h/const.h"
 #include "../h/types.h"
-#include "/usr/include/uarm/libuarm.h"
+#include "uarm/libuarm.h"
 
 void scheduler(){
+	kernelSwitch(KPSCHED); // the rest of this kernel entry is scheduling
+
 	// Case 1: We are in an error, complete, or wait state
 	// 	(Follows the "tree" above)
 	if (emptyProcQ(g_readyQueue)){
 		if(g_procCount == 0){		// done with all jobs
+			TRACEFLUSH();			// get the rest of the trace onto its disk
+			klog(KL_INFO, "all processes done, halting");
+			klogFlush();			// and the rest of the log onto its terminal
+			RECORDDUMP();			// and the phase 1 calls onto terminal 0 (-DKRECORD)
 			HALT();
 		}	
-		if(g_softBlockCount == 0){	// deadlock acheived
+		if((g_softBlockCount == 0) && emptyProcQ(g_throttledQueue)){	// deadlock acheived
+			flightDump(FR_DEADLOCK);	// leave a post-mortem on terminal 1
 			PANIC();
 		}
 
@@ -55,6 +84,8 @@ void scheduler(){
 		
 		g_endOfInterval = getTODLO() + INTERVAL;	// update when the interval should end
 		setTIMER(g_endOfInterval - getTODLO()); 	// wait for remainder of timer
+		TRACEIDLE();								// nothing to run, so export some trace
+		kernelIdle(g_endOfInterval - INTERVAL);		// idle from here until the interrupt
 		WAIT();
 	}
 
@@ -62,16 +93,187 @@ void scheduler(){
 
 	g_currentProc = removeProcQ(&(g_readyQueue));
 
+	// Out of CPU budget? Park it (or kill it) and pick someone else
+	if(g_budgetsInUse){
+		pcb_PTR budgetOwner = overBudget(g_currentProc);
+
+		if(budgetOwner != NULL){
+			budgetOwner->p_throttles++;
+
+			if((budgetOwner->p_budgetFlags & BUDGETKILL) != 0){
+				klogHex(KL_WARN, "over CPU budget, killing pid ", budgetOwner->p_pid);
+				g_currentProc = NULL; // only picked, never ran - nothing to charge
+				depthFirstMurder(budgetOwner);
+				admitCreators();
+			}
+			else{
+				g_currentProc->p_throttled = TRUE;
+				insertProcQ(&(g_throttledQueue), g_currentProc);
+			}
+
+			g_currentProc = NULL;
+			scheduler();
+		}
+	}
+
 		// Case 2a: You don't have a partial quantum left
 	if( (g_endOfInterval - getTODLO()) < 0 || (g_endOfInterval - getTODLO()) >= QUANTUM){
-		setTIMER(QUANTUM); // You poor thing... This one's on the house!
+		armQuantum(QUANTUM); // You poor thing... This one's on the house!
 	}
 		// Case 2b: You have a partial quantum
 	else{
-		setTIMER(g_endOfInterval-getTODLO());	// Sorry, no refills
+		armQuantum(g_endOfInterval-getTODLO());	// Sorry, no refills
 	}
 	
 	g_startTOD = getTODLO(); 					// Start timer before heading off
+	kernelLeaveAt(g_startTOD);
+	g_currentProc->p_dispatches++;
+	g_currentProc->p_readyTime = g_currentProc->p_readyTime + (g_startTOD - g_currentProc->p_stamp);
+	latencyDispatched(g_currentProc, g_startTOD);
+	TRACE(TR_DISPATCH, g_currentProc, 0);
 	loadState();
 	
-}
\ No newline at end of file
+}
+
+/* ---- armQuantum() ---------------------------------------
+* Parameters: 	int timeSlice
+* Type: 		Public
+* Return:		None
+* Description:
+*	Start a time slice of timeSlice and remember when it ends.
+*	While the profiler wants samples more often than that, the
+*	timer only runs for one sampling period at a time;
+*	lineTwoHandler() keeps rearming it until g_endOfQuantum.
+* --------------------------------- end armQuantum() ---- */
+void armQuantum(int timeSlice){
+	g_endOfQuantum = getTODLO() + timeSlice;
+
+	if(g_profiling && (g_profPeriod > 0) && (g_profPeriod < timeSlice)){
+		timeSlice = g_profPeriod; // wake up early to take a sample
+	}
+	setTIMER(timeSlice);
+}
+
+/* ---- makeReady() ---------------------------------------
+* Parameters: 	pcb_PTR p
+* Type: 		Public
+* Return:		None
+* Description:
+*	Every V, interrupt and pseudo-clock wake up funnels through here.
+*	A woken process normally goes to the back of g_readyQueue,
+*	but if its group was suspended while it was blocked it is parked
+*	on g_suspendedQueue instead, where the scheduler never looks.
+*	Also closes the blocked interval opened by markBlocked().
+* --------------------------------- end makeReady() ---- */
+void makeReady(pcb_PTR p){
+	int now = getTODLO();
+
+	if(p->p_blockCat != NOTBLOCKED){ // woken rather than replenished
+		TRACE(TR_WAKE, p, p->p_blockCat);
+		p->p_blockedTime[p->p_blockCat] = p->p_blockedTime[p->p_blockCat] + (now - p->p_stamp);
+		p->p_blockCat = NOTBLOCKED;
+	}
+	p->p_stamp = now; // waiting to run from here on
+
+	if(p->p_suspended){
+		insertProcQ(&(g_suspendedQueue), p); // RESUMEGROUP will move it over
+	}
+	else{
+		insertProcQ(&(g_readyQueue), p);
+	}
+}
+
+/* ---- markBlocked() ---------------------------------------
+* Parameters: 	pcb_PTR p, int category
+* Type: 		Public
+* Return:		None
+* Description:
+*	Count a voluntary switch and open a blocked interval of the
+*	given category (BLOCKSEM, BLOCKIO, BLOCKCLOCK), or a ready one
+*	for NOTBLOCKED (a yield). Must follow updateTime(), whose
+*	g_endTOD is reused so blocking costs no extra TOD read.
+* --------------------------------- end markBlocked() ---- */
+void markBlocked(pcb_PTR p, int category){
+	if(category != NOTBLOCKED){ // not a yield
+		TRACE(TR_BLOCK, p, category);
+	}
+	p->p_volSwitches++;
+	p->p_blockCat = category;
+	p->p_stamp = g_endTOD;
+}
+
+/* ---- chargeBudgets() ---------------------------------------
+* Parameters: 	pcb_PTR p, int time
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called from updateTime() with the time just added to p_time.
+*	Charges p's own budget and the subtree budget of every ancestor.
+*	A budget last charged in an earlier period starts again from 0,
+*	which is all a replenishment has to do.
+* --------------------------------- end chargeBudgets() ---- */
+void chargeBudgets(pcb_PTR p, int time){
+	pcb_PTR observedProcess = p;
+
+	while(observedProcess != NULL){
+		if((observedProcess->p_budget > 0) &&
+				((observedProcess == p) || ((observedProcess->p_budgetFlags & BUDGETSUBTREE) != 0))){
+
+			if(observedProcess->p_budgetEpoch != g_budgetEpoch){
+				observedProcess->p_budgetEpoch = g_budgetEpoch;
+				observedProcess->p_budgetUsed = 0;
+			}
+			observedProcess->p_budgetUsed = observedProcess->p_budgetUsed + time;
+		}
+		observedProcess = observedProcess->p_prnt;
+	}
+}
+
+/* ---- overBudget() ---------------------------------------
+* Parameters: 	pcb_PTR p
+* Type: 		Public
+* Return:		pcb_PTR or NULL
+* Description:
+*	Return the process whose exhausted budget covers p: p itself,
+*	or the nearest ancestor with an exhausted subtree budget.
+*	NULL means p may run.
+* --------------------------------- end overBudget() ---- */
+pcb_PTR overBudget(pcb_PTR p){
+	pcb_PTR observedProcess = p;
+
+	while(observedProcess != NULL){
+		if((observedProcess->p_budget > 0) &&
+				((observedProcess == p) || ((observedProcess->p_budgetFlags & BUDGETSUBTREE) != 0)) &&
+				(observedProcess->p_budgetEpoch == g_budgetEpoch) &&
+				(observedProcess->p_budgetUsed >= observedProcess->p_budget)){
+			return observedProcess;
+		}
+		observedProcess = observedProcess->p_prnt;
+	}
+	return (NULL);
+}
+
+/* ---- replenishBudgets() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called on every pseudo-clock tick. Every BUDGETPERIOD ticks,
+*	start a new budget period and hand every throttled process
+*	back to makeReady().
+* --------------------------------- end replenishBudgets() ---- */
+void replenishBudgets(){
+	g_budgetTicks++;
+	if(g_budgetTicks < BUDGETPERIOD){
+		return;
+	}
+	g_budgetTicks = 0;
+	g_budgetEpoch++; // every p_budgetUsed is now stale
+
+	pcb_PTR observedProcess = removeProcQ(&(g_throttledQueue));
+	while(observedProcess != NULL){
+		observedProcess->p_throttled = FALSE;
+		makeReady(observedProcess);
+		observedProcess = removeProcQ(&(g_throttledQueue));
+	}
+}
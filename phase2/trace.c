@@ -0,0 +1,345 @@
+/**************************************************************
+* FILENAME:		trace.c
+*
+* DESCRIPTION:	Kernel Trace Module for JaeOS
+*
+* NOTES:		Keeps the last TRACESIZE kernel events in a ring so the
+*				order of dispatches, preemptions, SYS calls, interrupts,
+*				blocks, wake ups, creations and terminations can be
+*				read back with SYS 25.
+*
+*				Tracepoints are placed with the TRACE() macro from
+*				trace.e. Unless the nucleus is built with -DKTRACE
+*				(make TRACEFLAGS=-DKTRACE) this ring is not even
+*				allocated; they then feed only the flight recorder
+*				(flight.c), if that is built with -DKFLIGHT.
+*
+*				Each event is a fixed 4 word traceev_t stamped with the
+*				TOD. Writing never blocks or fails: once the reader
+*				falls TRACESIZE events behind the oldest are overwritten,
+*				and the next read starts with a TR_LOST event saying
+*				how many went missing.
+*
+*				A SYS call's exit is the first loadState() after its
+*				entry, so a SYS that blocks exits when the nucleus
+*				next leaves for any process.
+*
+*				So long runs are not lost to the ring, an exporter
+*				streams events to disk TRACEDISK, one traceblk_t per
+*				sector from sector 0 on. It belongs to the nucleus:
+*				no process may SYS 8 on it, and its interrupts are
+*				taken by traceExportInterrupt() before they reach
+*				externalDeviceHandler(). Blocks are only started when
+*				the scheduler is about to WAIT, so exporting costs
+*				no process any CPU; a final flush just before HALT
+*				polls the disk so the tail of the trace is kept.
+*				The exporter reads the ring with its own cursor, so
+*				SYS 25 readers see every event too.
+*				tools/trace2json turns the disk image into a
+*				Chrome/Perfetto trace.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/trace.e"
+#include "uarm/libuarm.h"
+
+#ifdef KTRACE
+
+///////////////////////// DEFINITONS //////////////////////////
+
+HIDDEN traceev_t traceRing[TRACESIZE];
+HIDDEN unsigned int traceHead;		// events ever written
+HIDDEN unsigned int traceTail;		// events ever read (or lost)
+
+HIDDEN int sysPid;					// caller of the SYS in progress
+HIDDEN int sysNum;					// and its number, 0 if none
+
+HIDDEN unsigned int exportTail;		// events ever exported (or lost)
+HIDDEN traceblk_t exportBlock;		// the sector being written
+HIDDEN int exportState;				// EXPORTIDLE, EXPORTSEEKING, EXPORTWRITING, EXPORTFULL
+HIDDEN int exportSector;			// linear sector number of exportBlock
+HIDDEN BOOL exportPending;			// exportBlock is filled but not on disk yet
+
+// exportState values
+#define EXPORTIDLE			0
+#define EXPORTSEEKING		1
+#define EXPORTWRITING		2
+#define EXPORTFULL			3 	// ran off the end of the disk, stop exporting
+
+#define TRACEDISKREG		((dtpreg_t *) (DEVBASEADDRESS + (TRACEDISKINDEX * DEVWORDLENGTH)))
+
+HIDDEN int drainRing (unsigned int *tail, traceev_t *buffer, int maxEvents);
+HIDDEN void exportStart ();
+HIDDEN void exportStep ();
+
+#endif
+
+/////////////////////// TABLE OF CONTENTS ///////////////////////
+/********************* Public Functions *********************/
+//	   void traceEvent(int type, pcb_PTR proc, unsigned int arg);
+//	   void traceSysExit();
+//	   int traceRead(traceev_t *buffer, int maxEvents);
+//	   void traceExportIdle();
+//	   void traceExportFlush();
+//	   BOOL traceExportInterrupt(int semaphoreIndex);
+/********************* Private Functions *********************/
+//	   int drainRing(unsigned int *tail, traceev_t *buffer, int maxEvents);
+//	   void exportStart();
+//	   void exportStep();
+//////////////////// END TABLE OF CONTENTS ////////////////////
+
+
+/* ---- traceEvent() ---------------------------------------
+* Parameters: 	int type, pcb_PTR proc (may be NULL), unsigned int arg
+* Type: 		Public
+* Return:		None
+* Description:
+*	Append one event to the ring, overwriting the oldest if it
+*	is full. A TR_SYSENTER also remembers who made the call so
+*	traceSysExit() can close it.
+* --------------------------------- end traceEvent() ---- */
+void traceEvent(int type, pcb_PTR proc, unsigned int arg){
+#ifdef KTRACE
+	traceev_t *event = &(traceRing[traceHead & (TRACESIZE - 1)]);
+
+	event->t_tod = getTODLO();
+	event->t_type = type;
+	event->t_pid = 0;
+	if(proc != NULL){
+		event->t_pid = proc->p_pid;
+	}
+	event->t_arg = arg;
+
+	traceHead++;
+
+	if(type == TR_SYSENTER){
+		sysPid = event->t_pid;
+		sysNum = arg;
+	}
+#endif
+}
+
+/* ---- traceSysExit() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called on the way out of the nucleus (loadState()). Records
+*	the TR_SYSEXIT of the SYS call in progress, if there is one.
+* --------------------------------- end traceSysExit() ---- */
+void traceSysExit(){
+#ifdef KTRACE
+	if(sysNum != 0){
+		traceev_t *event = &(traceRing[traceHead & (TRACESIZE - 1)]);
+
+		event->t_tod = getTODLO();
+		event->t_type = TR_SYSEXIT;
+		event->t_pid = sysPid;
+		event->t_arg = sysNum;
+
+		traceHead++;
+		sysNum = 0;
+	}
+#endif
+}
+
+/* ---- traceRead() ---------------------------------------
+* Parameters: 	traceev_t *buffer, int maxEvents
+* Type: 		Public
+* Return:		Number of events copied into buffer
+* Description:
+*	Copy out up to maxEvents events SYS 25 has not seen yet.
+*	Always 0 when tracing is compiled out.
+* --------------------------------- end traceRead() ---- */
+int traceRead(traceev_t *buffer, int maxEvents){
+#ifdef KTRACE
+	return (drainRing(&traceTail, buffer, maxEvents));
+#else
+	return (0);
+#endif
+}
+
+/* ---- traceExportIdle() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called by the scheduler just before it WAITs. If the disk
+*	is free and there is something to export, start the next
+*	block; its interrupt will arrive while we wait anyway.
+* --------------------------------- end traceExportIdle() ---- */
+void traceExportIdle(){
+#ifdef KTRACE
+	if((exportState == EXPORTIDLE) && (exportPending || (exportTail != traceHead))){
+		exportStart();
+	}
+#endif
+}
+
+/* ---- traceExportFlush() ---------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None
+* Description:
+*	Called just before HALT: export everything that is left,
+*	polling the disk instead of waiting for its interrupts
+*	(there is nothing else to run by then). Gives up on the
+*	first failed operation rather than spin forever.
+* --------------------------------- end traceExportFlush() ---- */
+void traceExportFlush(){
+#ifdef KTRACE
+	unsigned int status;
+
+	while((exportState != EXPORTFULL) && ((exportState != EXPORTIDLE) || exportPending || (exportTail != traceHead))){
+		if(exportState == EXPORTIDLE){
+			exportStart();
+			continue; // may have found the disk full
+		}
+		do {
+			status = TRACEDISKREG->status;
+		} while((status & DEVSTATUSMASK) == DEVICEBUSY); // spin, interrupts are off in the nucleus
+		exportStep();
+		if((status & DEVSTATUSMASK) != DEVICEREADY){
+			return;
+		}
+	}
+#endif
+}
+
+/* ---- traceExportInterrupt() ---------------------------------------
+* Parameters: 	int semaphoreIndex
+* Type: 		Public
+* Return:		TRUE if the interrupt was the exporter's and has been handled
+* Description:
+*	The exporter's disk never has a process waiting on it, so its
+*	interrupts must not be turned into a V on its semaphore.
+* --------------------------------- end traceExportInterrupt() ---- */
+BOOL traceExportInterrupt(int semaphoreIndex){
+#ifdef KTRACE
+	if(semaphoreIndex == TRACEDISKINDEX){
+		exportStep();
+		return (TRUE);
+	}
+#endif
+	return (FALSE);
+}
+
+#ifdef KTRACE
+
+/* ---- drainRing() ---------------------------------------
+* Parameters: 	unsigned int *tail, traceev_t *buffer, int maxEvents
+* Type: 		Private
+* Return:		Number of events copied into buffer
+* Description:
+*	Copy out up to maxEvents events from *tail on, oldest first,
+*	and advance *tail past them. Each reader has its own tail.
+*	If the writer lapped this reader since it last read, the first
+*	event copied is a TR_LOST whose arg is how many were missed.
+* --------------------------------- end drainRing() ---- */
+HIDDEN int drainRing(unsigned int *tail, traceev_t *buffer, int maxEvents){
+	int copied = 0;
+
+	if((traceHead - *tail) > TRACESIZE){ // the writer lapped us
+		if(maxEvents <= 0){
+			return (0);
+		}
+		buffer[copied].t_tod = getTODLO();
+		buffer[copied].t_type = TR_LOST;
+		buffer[copied].t_pid = 0;
+		buffer[copied].t_arg = (traceHead - *tail) - TRACESIZE;
+		copied++;
+		*tail = traceHead - TRACESIZE;
+	}
+
+	while((copied < maxEvents) && (*tail != traceHead)){
+		buffer[copied] = traceRing[*tail & (TRACESIZE - 1)];
+		copied++;
+		(*tail)++;
+	}
+
+	return (copied);
+}
+
+/* ---- exportStart() ---------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		None
+* Description:
+*	Fill exportBlock from the ring and seek to the cylinder of
+*	exportSector. The geometry is read from the disk's DATA1
+*	(cylinders << 16 | heads << 8 | sectors), so any disk size works.
+*	A disk that is not installed, or has no geometry, counts as
+*	full from the start.
+* --------------------------------- end exportStart() ---- */
+HIDDEN void exportStart(){
+	dtpreg_t *disk = TRACEDISKREG;
+	unsigned int heads = (disk->data1 >> 8) & 0xFF;
+	unsigned int sectors = disk->data1 & 0xFF;
+	unsigned int cylinder;
+
+	if(((disk->status & DEVSTATUSMASK) == DEVNOTINSTALLED) || (heads == 0) || (sectors == 0)){
+		exportState = EXPORTFULL;
+		return;
+	}
+
+	cylinder = exportSector / (heads * sectors);
+	if(cylinder >= (disk->data1 >> 16)){ // disk is full, or has no cylinders
+		exportState = EXPORTFULL;
+		return;
+	}
+
+	if(!exportPending){ // else retry the block that failed last time
+		exportBlock.b_magic = TRACEMAGIC;
+		exportBlock.b_seq = exportSector;
+		exportBlock.b_count = drainRing(&exportTail, exportBlock.b_events, TRACEBLKEVENTS);
+		exportBlock.b_pad = 0;
+		exportPending = TRUE;
+	}
+
+	exportState = EXPORTSEEKING;
+	disk->command = (cylinder << 8) | DISKSEEKCYL;
+}
+
+/* ---- exportStep() ---------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		None
+* Description:
+*	The disk finished the last command: acknowledge it and move
+*	on. After a seek, write exportBlock to its sector; after a
+*	write, go idle and move on to the next sector.
+*	A failed seek or write leaves the block pending, so it is
+*	retried from the seek at the next idle.
+* --------------------------------- end exportStep() ---- */
+HIDDEN void exportStep(){
+	dtpreg_t *disk = TRACEDISKREG;
+	unsigned int status = disk->status;
+	unsigned int heads = (disk->data1 >> 8) & 0xFF;
+	unsigned int sectors = disk->data1 & 0xFF;
+
+	disk->command = ACK;
+
+	if(exportState == EXPORTFULL){
+		return; // stray interrupt, we are done with this disk
+	}
+
+	if((exportState == EXPORTSEEKING) && ((status & DEVSTATUSMASK) == DEVICEREADY)){
+		exportState = EXPORTWRITING;
+		disk->data0 = (unsigned int) &exportBlock;
+		disk->command = (((exportSector / sectors) % heads) << 16) | ((exportSector % sectors) << 8) | DISKWRITEBLK;
+		return;
+	}
+
+	if((exportState == EXPORTWRITING) && ((status & DEVSTATUSMASK) == DEVICEREADY)){
+		exportPending = FALSE; // it's on the disk
+		exportSector++;
+	}
+	exportState = EXPORTIDLE;
+}
+
+#endif
@@ -0,0 +1,405 @@
+/**************************************************************
+* FILENAME:		uthread.c
+*
+* DESCRIPTION:	User-Level Threads Library for JaeOS
+*
+* NOTES:		Multiplexes up to MAXUTHREADS threads onto a few kernel
+*				processes ("hosts") without any help from the nucleus
+*				for switching: a switch is an STST of the old thread's
+*				registers and an LDST of the new thread's.
+*
+*				The nucleus only helps when a thread blocks in the kernel.
+*				uthreadRun() registers an upcall (SYS 19) so that when
+*				the host blocks in a P or a SYS 8 a new activation starts
+*				in uthreadUpcall(), claims a free host slot and keeps
+*				running the other threads. Activations SYS 2 themselves
+*				once the run queue is empty.
+*
+*				Hosts share the run queue, so it is only touched with
+*				interrupts disabled (every process runs in SYS mode).
+*				Every saved context therefore has interrupts disabled,
+*				and whoever is resumed turns them back on.
+*
+*				Threads are told apart by their stack: uthreadSelf()
+*				finds the thread whose stack holds the current sp,
+*				so no global "current thread" has to survive preemption.
+*
+*				Stack layout below the stackTop given to uthreadInit():
+*					slot 0:	the upcall stack (the original host runs on
+*							its own stack)
+*					slot n:	host n's stack, n = 1 .. MAXHOSTS-1
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../e/uthread.e"
+#include "uarm/libuarm.h"
+
+///////////////////////// DEFINITONS //////////////////////////
+
+// User Thread Descriptor
+typedef struct uthread_t {
+	struct uthread_t 	*ut_next;		// next thread on the run queue
+	state_t 			ut_ctx;			// registers while not running
+	unsigned int 		ut_stackTop;	// its stack identifies it
+	void 				(*ut_body)();	// what it runs
+	int 				ut_host;		// host slot it was last dispatched on
+	BOOL 				ut_inUse;
+} uthread_t;
+
+// Host Descriptor: one per kernel process running threads
+typedef struct host_t {
+	state_t 			h_ctx;			// where the host loop resumes
+	unsigned int 		h_stackTop;
+	BOOL 				h_inUse;
+} host_t;
+
+HIDDEN uthread_t threadTable[MAXUTHREADS];
+HIDDEN host_t hostTable[MAXHOSTS];
+
+HIDDEN uthread_t *runQ_h, *runQ_t;		// FIFO run queue
+HIDDEN int liveThreads;					// created and not yet exited
+HIDDEN BOOL originalWaiting;			// original host asleep on allDone
+HIDDEN int allDone;						// semaphore the original host sleeps on
+
+HIDDEN state_t upcallState;				// SYS 19 vector
+HIDDEN state_t bootState;				// scratch for starting a host
+
+//////////////////// FUNCTION DECLARATIONS ////////////////////
+/********************* Public Functions **********************/
+void uthreadInit(unsigned int stackTop);
+int uthreadCreate(void (*body)(), unsigned int stackTop);
+void uthreadYield();
+void uthreadExit();
+void uthreadRun();
+/********************* Private Functions *********************/
+HIDDEN uthread_t *uthreadSelf();
+HIDDEN void enqueue(uthread_t *t);
+HIDDEN uthread_t *dequeue();
+HIDDEN void runNext(int slot);
+HIDDEN void hostLoop(int slot);
+HIDDEN void hostEntry(int slot);
+HIDDEN void threadStart();
+void uthreadUpcall(int blockedPid);
+////////////////////// End Declarations ///////////////////////
+
+
+////////////////////// Public Functions ///////////////////////
+
+/* ---- uthreadInit() -----------------------------------------
+* Parameters: 	unsigned int stackTop
+* Type: 		Public
+* Return:		None
+* Description:
+*	Reset the library and carve the upcall and host stacks
+*	(MAXHOSTS * UTSTACKSIZE bytes) down from stackTop.
+*	Must be called before any other uthread function.
+* ------------------------------------ end uthreadInit() ---- */
+void uthreadInit(unsigned int stackTop){
+	for (int i = 0; i < MAXUTHREADS; i++){
+		threadTable[i].ut_inUse = FALSE;
+	}
+	for (int i = 0; i < MAXHOSTS; i++){
+		hostTable[i].h_inUse = FALSE;
+		hostTable[i].h_stackTop = stackTop - (i * UTSTACKSIZE);
+	}
+	hostTable[ORIGINALHOST].h_inUse = TRUE;	// whoever calls uthreadRun()
+
+	runQ_h = NULL;
+	runQ_t = NULL;
+	liveThreads = 0;
+	originalWaiting = FALSE;
+	allDone = 0;
+
+	// Activations start in uthreadUpcall() on slot 0's stack, interrupts off
+	STST(&upcallState);
+	upcallState.sp = hostTable[ORIGINALHOST].h_stackTop;
+	upcallState.pc = (unsigned int) uthreadUpcall;
+	upcallState.cpsr = ALLOFF | INTSDISABLED | SYSMODE;
+}
+
+/* ---- uthreadCreate() ---------------------------------------
+* Parameters: 	void (*body)(), unsigned int stackTop
+* Type: 		Public
+* Return:		thread index or FAILURE
+* Description:
+*	Make a thread that runs body() on the UTSTACKSIZE bytes below
+*	stackTop and put it at the back of the run queue.
+*	Returning from body() is the same as calling uthreadExit().
+* ---------------------------------- end uthreadCreate() ---- */
+int uthreadCreate(void (*body)(), unsigned int stackTop){
+	unsigned int status = getSTATUS();
+	setSTATUS(status | INTSDISABLED);
+
+	for (int i = 0; i < MAXUTHREADS; i++){
+		if (!threadTable[i].ut_inUse){
+			uthread_t *newThread = &(threadTable[i]);
+			newThread->ut_inUse = TRUE;
+			newThread->ut_body = body;
+			newThread->ut_stackTop = stackTop;
+
+			STST(&(newThread->ut_ctx));
+			newThread->ut_ctx.sp = stackTop;
+			newThread->ut_ctx.pc = (unsigned int) threadStart;
+			newThread->ut_ctx.cpsr = ALLOFF | INTSDISABLED | SYSMODE;
+
+			liveThreads++;
+			enqueue(newThread);
+
+			setSTATUS(status);
+			return i;
+		}
+	}
+
+	setSTATUS(status);
+	return FAILURE;
+}
+
+/* ---- uthreadYield() ----------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None (once the thread is picked again)
+* Description:
+*	Go to the back of the run queue and switch to the thread at
+*	the front, entirely in user code. The STST/LDST pair works like
+*	setjmp/longjmp: the saved context resumes just after the STST,
+*	and the flag on our own stack tells the two returns apart.
+*	Does nothing if not called from a thread.
+* ----------------------------------- end uthreadYield() ---- */
+void uthreadYield(){
+	volatile BOOL resumed = FALSE;
+	uthread_t *self = uthreadSelf();
+
+	if (self == NULL){
+		return;
+	}
+
+	unsigned int status = getSTATUS();
+	setSTATUS(status | INTSDISABLED);
+
+	enqueue(self);
+	STST(&(self->ut_ctx));
+	if (!resumed){
+		resumed = TRUE;
+		runNext(self->ut_host);		// does not return
+	}
+
+	setSTATUS(status);				// we were picked again
+}
+
+/* ---- uthreadExit() -----------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None (never returns)
+* Description:
+*	Free the calling thread and run the next one on this host.
+* ------------------------------------ end uthreadExit() ---- */
+void uthreadExit(){
+	uthread_t *self = uthreadSelf();
+
+	setSTATUS(getSTATUS() | INTSDISABLED);
+
+	self->ut_inUse = FALSE;
+	liveThreads--;
+	runNext(self->ut_host);
+}
+
+/* ---- uthreadRun() ------------------------------------------
+* Parameters: 	None
+* Type: 		Public
+* Return:		None (once every thread has exited)
+* Description:
+*	Turn the calling process into the original host: arm the upcall
+*	and run threads until all of them have exited, then disarm it.
+* ------------------------------------- end uthreadRun() ---- */
+void uthreadRun(){
+	SYSCALL(SPECUPCALL, (int)&upcallState, 0, 0);
+	hostLoop(ORIGINALHOST);
+	SYSCALL(SPECUPCALL, 0, 0, 0);
+}
+
+///////////////////// Private and Helper Functions /////////////////////
+
+/* ---- uthreadSelf() -----------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		uthread_t * or NULL
+* Description:
+*	Find the thread whose stack we are running on.
+*	NULL means we are on a host stack, not in a thread.
+* ------------------------------------ end uthreadSelf() ---- */
+HIDDEN uthread_t *uthreadSelf(){
+	int marker; // lives on the current stack
+	unsigned int sp = (unsigned int) &marker;
+
+	for (int i = 0; i < MAXUTHREADS; i++){
+		if ((threadTable[i].ut_inUse) && (sp <= threadTable[i].ut_stackTop)
+				&& (sp > threadTable[i].ut_stackTop - UTSTACKSIZE)){
+			return &(threadTable[i]);
+		}
+	}
+	return (NULL);
+}
+
+/* ---- enqueue() ---------------------------------------------
+* Parameters: 	uthread_t *t
+* Type: 		Private
+* Return:		None
+* Description:
+*	Put t at the back of the run queue. Interrupts must be off.
+* --------------------------------------- end enqueue() ---- */
+HIDDEN void enqueue(uthread_t *t){
+	t->ut_next = NULL;
+	if (runQ_t == NULL){
+		runQ_h = t;
+	}
+	else{
+		runQ_t->ut_next = t;
+	}
+	runQ_t = t;
+}
+
+/* ---- dequeue() ---------------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		uthread_t * or NULL
+* Description:
+*	Take the thread at the front of the run queue, NULL if empty.
+*	Interrupts must be off.
+* --------------------------------------- end dequeue() ---- */
+HIDDEN uthread_t *dequeue(){
+	uthread_t *t = runQ_h;
+	if (t != NULL){
+		runQ_h = t->ut_next;
+		if (runQ_h == NULL){
+			runQ_t = NULL;
+		}
+	}
+	return t;
+}
+
+/* ---- runNext() ---------------------------------------------
+* Parameters: 	int slot
+* Type: 		Private
+* Return:		None (never returns)
+* Description:
+*	Load the next runnable thread on this host, or go back to the
+*	host loop if there is none. Interrupts must be off.
+* --------------------------------------- end runNext() ---- */
+HIDDEN void runNext(int slot){
+	uthread_t *next = dequeue();
+
+	if (next == NULL){
+		LDST(&(hostTable[slot].h_ctx));
+	}
+	next->ut_host = slot;
+	LDST(&(next->ut_ctx));
+}
+
+/* ---- hostLoop() --------------------------------------------
+* Parameters: 	int slot
+* Type: 		Private
+* Return:		None (only the original host ever returns)
+* Description:
+*	Run threads until the run queue is empty, then:
+*		Activation: free the slot and SYS 2 (waking the original
+*			host if it was the last one out)
+*		Original host, no threads left: return
+*		Original host, threads blocked elsewhere: sleep with the
+*			upcall off until the last activation is done
+* ------------------------------------- end hostLoop() ---- */
+HIDDEN void hostLoop(int slot){
+	unsigned int status = getSTATUS();
+	setSTATUS(status | INTSDISABLED);
+
+	while (TRUE){
+		if (runQ_h != NULL){
+			volatile BOOL resumed = FALSE;
+
+			STST(&(hostTable[slot].h_ctx));
+			if (!resumed){
+				resumed = TRUE;
+				runNext(slot);		// comes back here when the queue drains
+			}
+		}
+
+		else if (slot != ORIGINALHOST){
+			hostTable[slot].h_inUse = FALSE;
+			if ((liveThreads == 0) && originalWaiting){
+				originalWaiting = FALSE;
+				SYSCALL(VERHOGEN, (int)&allDone, 0, 0);
+			}
+			SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+		}
+
+		else if (liveThreads == 0){
+			setSTATUS(status);
+			return;
+		}
+
+		else{
+			originalWaiting = TRUE;
+			SYSCALL(SPECUPCALL, 0, 0, 0);	// no activation for this P
+			SYSCALL(PASSEREN, (int)&allDone, 0, 0);
+			SYSCALL(SPECUPCALL, (int)&upcallState, 0, 0);
+		}
+	}
+}
+
+/* ---- hostEntry() -------------------------------------------
+* Parameters: 	int slot
+* Type: 		Private
+* Return:		None (never returns)
+* Description:
+*	First function on a new activation's own stack.
+* ------------------------------------- end hostEntry() ---- */
+HIDDEN void hostEntry(int slot){
+	hostLoop(slot);
+}
+
+/* ---- threadStart() -----------------------------------------
+* Parameters: 	None
+* Type: 		Private
+* Return:		None (never returns)
+* Description:
+*	First function of every thread: interrupts on, run the body,
+*	exit if the body returns.
+* ----------------------------------- end threadStart() ---- */
+HIDDEN void threadStart(){
+	uthread_t *self = uthreadSelf();
+
+	setSTATUS(getSTATUS() & INTSENABLED);
+	self->ut_body();
+	uthreadExit();
+}
+
+/* ---- uthreadUpcall() ---------------------------------------
+* Parameters: 	int blockedPid (A1, set by the nucleus)
+* Type: 		Public (its address is the upcall vector)
+* Return:		None (never returns)
+* Description:
+*	Where the nucleus starts a new activation when a host blocks.
+*	Runs on the shared upcall stack with interrupts off, so no other
+*	activation can be here at the same time: claim a host slot and
+*	move onto its stack. With no slot free there is nothing to do.
+* ---------------------------------- end uthreadUpcall() ---- */
+void uthreadUpcall(int blockedPid){
+	for (int i = 0; i < MAXHOSTS; i++){
+		if (!hostTable[i].h_inUse){
+			hostTable[i].h_inUse = TRUE;
+
+			STST(&bootState);
+			bootState.sp = hostTable[i].h_stackTop;
+			bootState.pc = (unsigned int) hostEntry;
+			bootState.a1 = i;
+			bootState.cpsr = ALLOFF | INTSDISABLED | SYSMODE;
+			LDST(&bootState);
+		}
+	}
+
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
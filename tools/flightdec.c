@@ -0,0 +1,188 @@
+/**************************************************************
+* FILENAME:		flightdec.c
+*
+* DESCRIPTION:	Flight Recorder Decoder for JaeOS (runs on the host)
+*
+* NOTES:		Reads the log of the terminal the nucleus dumps its
+*				flight recorder to before PANICing (terminal 1, see
+*				phase2/flight.c) and prints it in words:
+*
+*					flightdec [-s ticksPerUs] term1.uarm
+*
+*				Event times are shown relative to the PANIC, in ticks
+*				or, with -s, in microseconds. Anything in the log
+*				before the FLT line (or after END) is ignored, so the
+*				terminal may also have been used for other output.
+*				If there are several dumps the last one is decoded.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Must match h/const.h
+#define TR_SYSENTER			3
+#define TR_SYSEXIT			4
+#define TR_INTERRUPT		5
+#define TR_BLOCK			6
+#define TR_WAKE				7
+#define TR_CREATE			8
+#define TR_LOST				10
+#define FR_CLOCKWAIT		6
+#define BLOCKCATS			3
+
+#define MAXLINE				1024
+#define MAXLINES			4096
+
+static const char *reasons[] = {"?", "deadlock: nothing ready or soft blocked",
+	"interrupt with no line pending", "line pending with no device",
+	"line 0 or 1 reached the device handler", "semaphore waiter missing from the ASL",
+	"SYS 7 could not block"};
+static const char *events[] = {"?", "dispatch", "quantum end", "SYS enter", "SYS exit",
+	"interrupt", "block", "wake", "create", "terminate", "lost"};
+static const char *blockNames[] = {"P", "SYS 8", "SYS 7"};
+
+static char *lines[MAXLINES];
+static int lineCount;
+
+
+/* ---- when() ---------------------------------------
+* Description:	print an event time relative to the PANIC
+* --------------------------------- end when() ---- */
+static void when(unsigned int tod, unsigned int panicTOD, double ticksPerUs){
+	unsigned int before = panicTOD - tod; // wraps correctly
+
+	if(ticksPerUs > 0){
+		printf("%12.1f us  ", -((double) before / ticksPerUs));
+	}
+	else{
+		printf("%12d     ", -((int) before));
+	}
+}
+
+/* ---- decodeEvent() ---------------------------------------
+* Description:	print one E line
+* --------------------------------- end decodeEvent() ---- */
+static void decodeEvent(unsigned int type, unsigned int pid, unsigned int arg){
+	printf("%-12s", (type <= TR_LOST) ? events[type] : "?");
+	if(pid != 0){
+		printf(" pid %-6u", pid);
+	}
+	else{
+		printf(" %-10s", "");
+	}
+
+	switch(type){
+		case TR_SYSENTER:
+		case TR_SYSEXIT:
+			printf(" SYS %u", arg);
+			break;
+		case TR_INTERRUPT:
+			printf(" line %u dev %u", arg >> 8, arg & 0xFF);
+			break;
+		case TR_BLOCK:
+		case TR_WAKE:
+			printf(" %s", (arg < BLOCKCATS) ? blockNames[arg] : "?");
+			break;
+		case TR_CREATE:
+			printf(" by pid %u", arg);
+			break;
+		case TR_LOST:
+			printf(" %u events", arg);
+			break;
+	}
+	printf("\n");
+}
+
+
+int main(int argc, char *argv[]){
+	double ticksPerUs = 0;
+	const char *path = NULL;
+	char buf[MAXLINE];
+	FILE *file;
+	int i, start = -1;
+	unsigned int reason, panicTOD, current, procCount, softBlocked;
+	unsigned int tod, type, pid, arg, semAdd, value;
+
+	for(i = 1; i < argc; i++){
+		if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)){
+			ticksPerUs = atof(argv[++i]);
+		}
+		else{
+			path = argv[i];
+		}
+	}
+	if(path == NULL){
+		fprintf(stderr, "usage: %s [-s ticksPerUs] terminallog\n", argv[0]);
+		return (1);
+	}
+
+	file = fopen(path, "r");
+	if(file == NULL){
+		perror(path);
+		return (1);
+	}
+	while((lineCount < MAXLINES) && (fgets(buf, sizeof(buf), file) != NULL)){
+		char *dump = strstr(buf, "FLT ");
+		if(dump != NULL){
+			start = lineCount; // the header may follow other output on its line
+			memmove(buf, dump, strlen(dump) + 1);
+		}
+		lines[lineCount++] = strdup(buf);
+	}
+	fclose(file);
+
+	if((start < 0) || (sscanf(lines[start], "FLT %x %x %x %x %x", &reason, &panicTOD, &current, &procCount, &softBlocked) != 5)){
+		fprintf(stderr, "%s: no flight recorder dump found\n", path);
+		return (1);
+	}
+
+	printf("PANIC: %s\n", (reason <= FR_CLOCKWAIT) ? reasons[reason] : "?");
+	printf("running pid %u, %u processes, %u soft blocked\n\n", current, procCount, softBlocked);
+
+	for(i = start + 1; i < lineCount; i++){
+		char *line = lines[i];
+		char *word;
+
+		if(strncmp(line, "END", 3) == 0){
+			break;
+		}
+
+		switch(line[0]){
+			case 'E':
+				if(sscanf(line, "E %x %x %x %x", &tod, &type, &pid, &arg) == 4){
+					when(tod, panicTOD, ticksPerUs);
+					decodeEvent(type, pid, arg);
+				}
+				break;
+
+			case 'S':
+				printf("\nsoft blocked, oldest tick first:");
+				for(word = strtok(line + 1, " \n"); word != NULL; word = strtok(NULL, " \n")){
+					printf(" %lu", strtoul(word, NULL, 16));
+				}
+				printf("\n");
+				break;
+
+			case 'R':
+			case 'T':
+			case 'P':
+				printf("%s queue:", (line[0] == 'R') ? "ready" : ((line[0] == 'T') ? "throttled" : "suspended"));
+				for(word = strtok(line + 1, " \n"); word != NULL; word = strtok(NULL, " \n")){
+					printf(" %lu", strtoul(word, NULL, 16));
+				}
+				printf("\n");
+				break;
+
+			case 'B':
+				if(sscanf(line, "B %x %x %x", &pid, &semAdd, &value) == 3){
+					printf("pid %u blocked on semaphore 0x%08x (value %d)\n", pid, semAdd, (int) value);
+				}
+				break;
+		}
+	}
+	return (0);
+}
@@ -0,0 +1,245 @@
+/**************************************************************
+* FILENAME:		profsym.c
+*
+* DESCRIPTION:	Profile Symbolizer for JaeOS (runs on the host)
+*
+* NOTES:		Turns the PC histogram read with SYS 28 into a flat
+*				profile by function:
+*
+*					profsym [-p] kernel.bench.uarm term0.uarm
+*
+*				The log is any text holding "PROF pid pc count" lines
+*				(pc in hex), such as a uARM terminal file p2bench
+*				printed to; other lines are ignored. With -p every
+*				process gets its own rows.
+*
+*				Symbols come straight from the image's ELF32 symbol
+*				table (functions, plus untyped text labels such as the
+*				library's assembly entry points), so no binutils are
+*				needed. A PC belongs to the closest symbol at or below it.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHT_SYMTAB			2
+#define STT_NOTYPE			0
+#define STT_FUNC			2
+#define SHN_UNDEF			0
+
+#define MAXROWS				8192
+
+typedef struct symbol_t {
+	unsigned int	s_addr;
+	const char		*s_name;
+} symbol_t;
+
+typedef struct row_t {
+	const char		*r_name;
+	int				r_pid;		// -1 when not split by process
+	long			r_count;
+} row_t;
+
+static unsigned char *image;
+static long imageSize;
+
+static symbol_t *symbols;
+static int symbolCount;
+
+static row_t rows[MAXROWS];
+static int rowCount;
+
+
+/* ---- half() / word() ---------------------------------------
+* Return:		the little-endian value at image[offset]
+* --------------------------------- end half() / word() ---- */
+static unsigned int half(long offset){
+	return ((unsigned int) image[offset]) | ((unsigned int) image[offset + 1] << 8);
+}
+
+static unsigned int word(long offset){
+	return half(offset) | (half(offset + 2) << 16);
+}
+
+static int bySymbolAddr(const void *a, const void *b){
+	unsigned int x = ((const symbol_t *) a)->s_addr;
+	unsigned int y = ((const symbol_t *) b)->s_addr;
+	return (x > y) - (x < y);
+}
+
+static int byRowCount(const void *a, const void *b){
+	long x = ((const row_t *) a)->r_count;
+	long y = ((const row_t *) b)->r_count;
+	return (x < y) - (x > y);
+}
+
+/* ---- loadSymbols() ---------------------------------------
+* Description:	read every function symbol out of the ELF image
+* --------------------------------- end loadSymbols() ---- */
+static int loadSymbols(const char *path){
+	FILE *file = fopen(path, "rb");
+	long shoff, sh, symoff, stroff, i, count;
+	int shentsize, shnum, s;
+
+	if(file == NULL){
+		perror(path);
+		return (0);
+	}
+	fseek(file, 0, SEEK_END);
+	imageSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	image = malloc(imageSize > 0 ? imageSize : 1);
+	if((image == NULL) || (fread(image, 1, imageSize, file) != (size_t) imageSize)){
+		fprintf(stderr, "%s: could not read image\n", path);
+		return (0);
+	}
+	fclose(file);
+
+	if((imageSize < 52) || (memcmp(image, "\177ELF", 4) != 0) || (image[4] != 1) || (image[5] != 1)){
+		fprintf(stderr, "%s: not a little-endian ELF32 file\n", path);
+		return (0);
+	}
+
+	shoff = word(32);
+	shentsize = half(46);
+	shnum = half(48);
+
+	for(s = 0; s < shnum; s++){
+		sh = shoff + (s * shentsize);
+		if(word(sh + 4) != SHT_SYMTAB){
+			continue;
+		}
+
+		symoff = word(sh + 16);
+		count = word(sh + 20) / 16;
+		stroff = word(shoff + (word(sh + 24) * shentsize) + 16); // the linked string table
+
+		symbols = malloc(count * sizeof(symbol_t));
+		for(i = 0; i < count; i++){
+			long sym = symoff + (i * 16);
+			int type = image[sym + 12] & 0xF;
+
+			if((half(sym + 14) == SHN_UNDEF) || ((type != STT_FUNC) && (type != STT_NOTYPE))){
+				continue;
+			}
+			if((image[stroff + word(sym)] == '\0') || (image[stroff + word(sym)] == '$')){
+				continue; // unnamed, or an ARM mapping symbol ($a, $d, $t)
+			}
+			symbols[symbolCount].s_addr = word(sym + 4) & ~1u; // drop the Thumb bit
+			symbols[symbolCount].s_name = (const char *) &image[stroff + word(sym)];
+			symbolCount++;
+		}
+	}
+
+	qsort(symbols, symbolCount, sizeof(symbol_t), bySymbolAddr);
+	return (symbolCount > 0);
+}
+
+/* ---- symbolize() ---------------------------------------
+* Return:		name of the closest symbol at or below pc
+* --------------------------------- end symbolize() ---- */
+static const char *symbolize(unsigned int pc){
+	int low = 0, high = symbolCount - 1, found = -1;
+
+	while(low <= high){
+		int middle = (low + high) / 2;
+		if(symbols[middle].s_addr <= pc){
+			found = middle;
+			low = middle + 1;
+		}
+		else{
+			high = middle - 1;
+		}
+	}
+	return ((found < 0) ? "[unknown]" : symbols[found].s_name);
+}
+
+/* ---- count() ---------------------------------------
+* Description:	add samples to the (name, pid) row
+* --------------------------------- end count() ---- */
+static void count(const char *name, int pid, long samples){
+	int i;
+
+	for(i = 0; i < rowCount; i++){
+		if((rows[i].r_pid == pid) && (strcmp(rows[i].r_name, name) == 0)){
+			rows[i].r_count = rows[i].r_count + samples;
+			return;
+		}
+	}
+	if(rowCount < MAXROWS){
+		rows[rowCount].r_name = name;
+		rows[rowCount].r_pid = pid;
+		rows[rowCount].r_count = samples;
+		rowCount++;
+	}
+}
+
+
+int main(int argc, char *argv[]){
+	int perProcess = 0;
+	const char *elfPath = NULL, *logPath = NULL;
+	FILE *log;
+	char line[256];
+	long total = 0;
+	int i;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "-p") == 0){
+			perProcess = 1;
+		}
+		else if(elfPath == NULL){
+			elfPath = argv[i];
+		}
+		else{
+			logPath = argv[i];
+		}
+	}
+	if(elfPath == NULL){
+		fprintf(stderr, "usage: %s [-p] kernel.core.uarm [log]\n", argv[0]);
+		return (1);
+	}
+	if(!loadSymbols(elfPath)){
+		fprintf(stderr, "%s: no symbols\n", elfPath);
+		return (1);
+	}
+
+	log = (logPath == NULL) ? stdin : fopen(logPath, "r");
+	if(log == NULL){
+		perror(logPath);
+		return (1);
+	}
+
+	while(fgets(line, sizeof(line), log) != NULL){
+		char *prof = strstr(line, "PROF ");
+		int pid;
+		unsigned int pc;
+		long samples;
+
+		if((prof == NULL) || (sscanf(prof, "PROF %d %x %ld", &pid, &pc, &samples) != 3)){
+			continue;
+		}
+		count(((pid == 0) && (pc == 0)) ? "[overflow]" : symbolize(pc), perProcess ? pid : -1, samples);
+		total = total + samples;
+	}
+
+	if(total == 0){
+		fprintf(stderr, "no PROF lines found\n");
+		return (1);
+	}
+
+	qsort(rows, rowCount, sizeof(row_t), byRowCount);
+
+	printf("%7s %8s  %s\n", "%", "samples", perProcess ? "pid function" : "function");
+	for(i = 0; i < rowCount; i++){
+		printf("%6.2f%% %8ld  ", (100.0 * rows[i].r_count) / total, rows[i].r_count);
+		if(perProcess){
+			printf("%d ", rows[i].r_pid);
+		}
+		printf("%s\n", rows[i].r_name);
+	}
+	return (0);
+}
@@ -0,0 +1,281 @@
+/**************************************************************
+* FILENAME:		trace2json.c
+*
+* DESCRIPTION:	Trace Converter for JaeOS (runs on the host)
+*
+* NOTES:		Reads the image file of the disk the nucleus exports its
+*				trace to (see phase2/trace.c, built with -DKTRACE) and
+*				writes Chrome/Perfetto trace JSON, ready for
+*				chrome://tracing or ui.perfetto.dev:
+*
+*					trace2json [-s ticksPerUs] disk1.uarm > trace.json
+*
+*				Every process gets its own track showing when it ran
+*				(a slice per dispatch) and instants for its SYS calls,
+*				blocks and wake ups. Interrupts go on a "nucleus" track.
+*
+*				The image is scanned for TRACEMAGIC on every word rather
+*				than assuming where sector 0 starts, so the device file
+*				header does not matter. Blocks are put back in b_seq
+*				order; events are little-endian words as uARM wrote them.
+*
+* AUTHORS:		Thomas Reichman; Ajiri Obaebor
+*				C commenting conventions adapted from http://syque.com/cstyle/ch4.htm
+**************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Must match h/const.h
+#define TRACEMAGIC			0x4352544B
+#define DISKBLOCKSIZE		4096
+#define TRACEBLKEVENTS		((DISKBLOCKSIZE / 16) - 1)
+#define TR_DISPATCH			1
+#define TR_QUANTUM			2
+#define TR_SYSENTER			3
+#define TR_SYSEXIT			4
+#define TR_INTERRUPT		5
+#define TR_BLOCK			6
+#define TR_WAKE				7
+#define TR_CREATE			8
+#define TR_TERMINATE		9
+#define TR_LOST				10
+
+#define MAXBLOCKS			65536
+#define MAXTRACKS			4096
+#define NUCLEUSTRACK		0 	// interrupts and anything without a process
+
+typedef struct event_t {
+	unsigned long long	e_time;		// TOD ticks, unwrapped
+	int					e_type;
+	int					e_pid;
+	unsigned int		e_arg;
+} event_t;
+
+static const char *blockNames[] = {"P", "SYS 8", "SYS 7"};
+
+static unsigned char *image;
+static long imageSize;
+
+static long blockOffset[MAXBLOCKS];	// where block b_seq starts in image, -1 if missing
+static int tracks[MAXTRACKS];		// PIDs that already have a thread_name
+static int trackCount;
+static int firstEvent = 1;
+
+
+/* ---- word() ---------------------------------------
+* Return:		the little-endian word at image[offset]
+* --------------------------------- end word() ---- */
+static unsigned int word(long offset){
+	return ((unsigned int) image[offset]) | ((unsigned int) image[offset + 1] << 8)
+		| ((unsigned int) image[offset + 2] << 16) | ((unsigned int) image[offset + 3] << 24);
+}
+
+/* ---- emit() ---------------------------------------
+* Description:	print one JSON event, with the separator before it
+* --------------------------------- end emit() ---- */
+static void emit(const char *json){
+	printf("%s\n  %s", firstEvent ? "" : ",", json);
+	firstEvent = 0;
+}
+
+/* ---- nameTrack() ---------------------------------------
+* Description:	give pid's track a name the first time it is seen
+* --------------------------------- end nameTrack() ---- */
+static void nameTrack(int pid){
+	char json[160];
+	int i;
+
+	for(i = 0; i < trackCount; i++){
+		if(tracks[i] == pid){
+			return;
+		}
+	}
+	if(trackCount < MAXTRACKS){
+		tracks[trackCount++] = pid;
+	}
+
+	if(pid == NUCLEUSTRACK){
+		snprintf(json, sizeof(json), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"nucleus\"}}");
+	}
+	else{
+		snprintf(json, sizeof(json), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"pid %d\"}}", pid, pid);
+	}
+	emit(json);
+}
+
+/* ---- instant() ---------------------------------------
+* Description:	a zero length marker on pid's track
+* --------------------------------- end instant() ---- */
+static void instant(int pid, double us, const char *name){
+	char json[200];
+
+	nameTrack(pid);
+	snprintf(json, sizeof(json), "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", name, pid, us);
+	emit(json);
+}
+
+/* ---- slice() ---------------------------------------
+* Description:	a "running" slice on pid's track
+* --------------------------------- end slice() ---- */
+static void slice(int pid, double startUs, double endUs){
+	char json[200];
+
+	nameTrack(pid);
+	snprintf(json, sizeof(json), "{\"ph\":\"X\",\"name\":\"running\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", pid, startUs, endUs - startUs);
+	emit(json);
+}
+
+
+int main(int argc, char *argv[]){
+	double ticksPerUs = 1.0;
+	const char *path = NULL;
+	FILE *file;
+	long offset;
+	int seq, i, count, blocks = 0;
+
+	unsigned long long now = 0;		// unwrapped TOD of the last event
+	unsigned int lastLow = 0;
+	int running = -1;				// PID with an open slice, -1 if none
+	double runStart = 0;
+	char name[64];
+
+	for(i = 1; i < argc; i++){
+		if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)){
+			ticksPerUs = atof(argv[++i]);
+		}
+		else{
+			path = argv[i];
+		}
+	}
+	if((path == NULL) || (ticksPerUs <= 0)){
+		fprintf(stderr, "usage: %s [-s ticksPerUs] diskimage\n", argv[0]);
+		return (1);
+	}
+
+	file = fopen(path, "rb");
+	if(file == NULL){
+		perror(path);
+		return (1);
+	}
+	fseek(file, 0, SEEK_END);
+	imageSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	image = malloc(imageSize > 0 ? imageSize : 1);
+	if((image == NULL) || (fread(image, 1, imageSize, file) != (size_t) imageSize)){
+		fprintf(stderr, "%s: could not read image\n", path);
+		return (1);
+	}
+	fclose(file);
+
+	// Find every block, whatever header the device file has
+	for(seq = 0; seq < MAXBLOCKS; seq++){
+		blockOffset[seq] = -1;
+	}
+	for(offset = 0; offset + DISKBLOCKSIZE <= imageSize; offset = offset + 4){
+		if(word(offset) != TRACEMAGIC){
+			continue;
+		}
+		seq = word(offset + 4);
+		count = word(offset + 8);
+		if((seq < MAXBLOCKS) && (count >= 0) && (count <= TRACEBLKEVENTS) && (blockOffset[seq] < 0)){
+			blockOffset[seq] = offset;
+			blocks++;
+			offset = offset + DISKBLOCKSIZE - 4; // skip the rest of this sector
+		}
+	}
+	if(blocks == 0){
+		fprintf(stderr, "%s: no trace blocks found\n", path);
+		return (1);
+	}
+
+	printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	// The exporter writes sectors in order, so stop at the first hole
+	for(seq = 0; (seq < MAXBLOCKS) && (blockOffset[seq] >= 0); seq++){
+		count = word(blockOffset[seq] + 8);
+
+		for(i = 0; i < count; i++){
+			long e = blockOffset[seq] + 16 + (16 * i);
+			unsigned int low = word(e);
+			int type = (int) word(e + 4);
+			int pid = (int) word(e + 8);
+			unsigned int arg = word(e + 12);
+			double us;
+
+			if((seq != 0 || i != 0) && (low < lastLow)){
+				now = now + (1ULL << 32); // TOD low word wrapped
+			}
+			now = (now & ~0xFFFFFFFFULL) | low;
+			lastLow = low;
+			us = (double) now / ticksPerUs;
+
+			switch(type){
+				case TR_DISPATCH:
+					if(running >= 0){
+						slice(running, runStart, us);
+					}
+					running = pid;
+					runStart = us;
+					break;
+
+				case TR_QUANTUM:
+				case TR_BLOCK:
+				case TR_TERMINATE:
+					if(running == pid){
+						slice(running, runStart, us);
+						running = -1;
+					}
+					if(type == TR_BLOCK){
+						snprintf(name, sizeof(name), "block %s", (arg < 3) ? blockNames[arg] : "?");
+						instant(pid, us, name);
+					}
+					else if(type == TR_TERMINATE){
+						instant(pid, us, "terminate");
+					}
+					break;
+
+				case TR_SYSENTER:
+					snprintf(name, sizeof(name), "SYS %u", arg);
+					instant(pid, us, name);
+					break;
+
+				case TR_SYSEXIT:
+					snprintf(name, sizeof(name), "SYS %u done", arg);
+					instant(pid, us, name);
+					break;
+
+				case TR_INTERRUPT:
+					snprintf(name, sizeof(name), "line %u dev %u", arg >> 8, arg & 0xFF);
+					instant(NUCLEUSTRACK, us, name);
+					break;
+
+				case TR_WAKE:
+					instant(pid, us, "wake");
+					break;
+
+				case TR_CREATE:
+					snprintf(name, sizeof(name), "created by %u", arg);
+					instant(pid, us, name);
+					break;
+
+				case TR_LOST:
+					snprintf(name, sizeof(name), "%u events lost", arg);
+					instant(NUCLEUSTRACK, us, name);
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	if(running >= 0){ // still running when the trace ends
+		slice(running, runStart, (double) now / ticksPerUs);
+	}
+
+	printf("\n]}\n");
+	fprintf(stderr, "%d blocks converted\n", seq);
+	return (0);
+}